@@ -186,12 +186,8 @@ size_t HttpParser::getBodyLen(const HttpRequest::Headers& headers) {
 }
 
 void HttpParser::readBody(std::istream& stream, std::string& body, const size_t bodyLen) {
-  size_t read = 0;
-
-  while (stream.good() && read < bodyLen) {
-    body += stream.get();
-    ++read;
-  }
+  body.resize(bodyLen);
+  stream.read(&body[0], bodyLen);
 
   if (!stream.good()) {
     throw std::runtime_error("stream is not good");
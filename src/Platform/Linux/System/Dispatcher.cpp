@@ -9,18 +9,73 @@
 #include <unistd.h>
 #include <sys/types.h>
 #include <sys/epoll.h>
+#include <sys/mman.h>
 #include <assert.h>
 #include <sys/time.h>
+#include <time.h>
 #include <errno.h>
+#include <algorithm>
+#include <climits>
 #include <stdexcept>
 
 using namespace System;
 
+namespace {
+
+struct StackContext {
+  ucontext_t context; //must be first, contexts are passed around as ucontext_t*
+  uint8_t* mapping;
+  std::size_t mappingSize;
+  std::size_t stackSize;
+};
+
+std::size_t getStackSizeClass(std::size_t stackSize) {
+  std::size_t sizeClass = Dispatcher::MIN_STACK_SIZE;
+  while (sizeClass < stackSize) {
+    sizeClass <<= 1;
+  }
+
+  return sizeClass;
+}
+
+//stack grows down, so the guard page is placed below it and an overflow faults instead of corrupting the neighbour
+StackContext* allocateStackContext(std::size_t stackSize) {
+  std::size_t pageSize = static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+  std::size_t mappingSize = stackSize + pageSize;
+  void* mapping = mmap(nullptr, mappingSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_STACK, -1, 0);
+  if (mapping == MAP_FAILED) {
+    std::cerr << "mmap() fail errno=" << errno << std::endl;
+    throw std::runtime_error("Dispatcher::spawn()");
+  }
+
+  if (mprotect(mapping, pageSize, PROT_NONE) == -1) {
+    std::cerr << "mprotect() fail errno=" << errno << std::endl;
+    munmap(mapping, mappingSize);
+    throw std::runtime_error("Dispatcher::spawn()");
+  }
+
+  StackContext* context = new StackContext;
+  context->mapping = static_cast<uint8_t*>(mapping);
+  context->mappingSize = mappingSize;
+  context->stackSize = stackSize;
+  return context;
+}
+
+void freeStackContext(StackContext* context) {
+  if (munmap(context->mapping, context->mappingSize) == -1) {
+    std::cerr << "munmap() fail errno=" << errno << std::endl;
+  }
+
+  delete context;
+}
+
+}
+
 void Dispatcher::contextProcedureStatic(void *context) {
   reinterpret_cast<Dispatcher*>(context)->contextProcedure();
 }
 
-Dispatcher::Dispatcher() {
+Dispatcher::Dispatcher() : timerWheel(getCurrentTick()) {
   epoll = ::epoll_create1(0);
   if (epoll == -1) {
     std::cerr << "kqueue() fail errno=" << errno << std::endl;
@@ -30,6 +85,8 @@ Dispatcher::Dispatcher() {
       std::cerr << "getcontext() fail errno=" << errno << std::endl;
     } else {
       contextCount = 0;
+      peakContextCount = 0;
+      stackPoolLimit = DEFAULT_STACK_POOL_LIMIT;
       return;
     }
   }
@@ -38,19 +95,19 @@ Dispatcher::Dispatcher() {
 
 Dispatcher::~Dispatcher() {
   assert(resumingContexts.empty());
-  assert(reusableContexts.size() == contextCount);
   assert(spawningProcedures.empty());
-  assert(reusableContexts.size() == allocatedStacks.size());
-  while (!reusableContexts.empty()) {
-    delete[] allocatedStacks.top();
-    allocatedStacks.pop();
-    delete static_cast<ucontext_t*>(reusableContexts.top());
-    reusableContexts.pop();
+  releaseRetiredContexts();
+  for (auto& pool : reusableContexts) {
+    while (!pool.second.empty()) {
+      freeStackContext(static_cast<StackContext*>(pool.second.top()));
+      pool.second.pop();
+      --contextCount;
+    }
   }
 
-  while (!timers.empty()) {
-    timers.pop();
-  }
+  assert(contextCount == 0);
+
+  assert(timerWheel.size() == 0);
 
   if (-1 == close(epoll)) {
     std::cerr << "close() fail errno=" << errno << std::endl;
@@ -65,33 +122,68 @@ int Dispatcher::getEpoll() const {
   return epoll;
 }
 
+TimerWheel& Dispatcher::getTimerWheel() {
+  return timerWheel;
+}
+
+uint64_t Dispatcher::getCurrentTick() const {
+  timespec now;
+  if (clock_gettime(CLOCK_MONOTONIC, &now) == -1) {
+    std::cerr << "clock_gettime() failed, errno=" << errno << std::endl;
+    throw std::runtime_error("Dispatcher::getCurrentTick()");
+  }
+
+  return static_cast<uint64_t>(now.tv_sec) * 1000 + static_cast<uint64_t>(now.tv_nsec) / 1000000;
+}
+
 void Dispatcher::pushContext(void* context) {
   resumingContexts.push(context);
 }
 
 void Dispatcher::spawn(std::function<void()>&& procedure) {
+  spawn(std::move(procedure), DEFAULT_STACK_SIZE);
+}
+
+void Dispatcher::spawn(std::function<void()>&& procedure, std::size_t stackSize) {
+  releaseRetiredContexts();
+  stackSize = getStackSizeClass(stackSize);
+  std::stack<void*>& pool = reusableContexts[stackSize];
   ucontext_t *context;
-  if (reusableContexts.empty()) {
-    context = new ucontext_t;
+  if (pool.empty()) {
+    StackContext* stackContext = allocateStackContext(stackSize);
+    context = &stackContext->context;
     if (getcontext(context) == -1) { //makecontext precondition
       std::cerr << "getcontext() fail errno=" << errno << std::endl;
+      freeStackContext(stackContext);
       throw std::runtime_error("Dispatcher::spawn()");
     }
-    auto stackPointer = new uint8_t[64 * 1024];
-    context->uc_stack.ss_sp = stackPointer;
-    allocatedStacks.push(stackPointer);
-    context->uc_stack.ss_size = 64 * 1024;
+    context->uc_stack.ss_sp = stackContext->mapping + (stackContext->mappingSize - stackSize);
+    context->uc_stack.ss_size = stackSize;
     makecontext(context, (void(*)())contextProcedureStatic, 1, reinterpret_cast<int*>(this));
-    ++contextCount;
+    if (++contextCount > peakContextCount) {
+      peakContextCount = contextCount;
+    }
   } else {
-    context = static_cast<ucontext_t*>(reusableContexts.top());
-    reusableContexts.pop();
+    context = static_cast<ucontext_t*>(pool.top());
+    pool.pop();
   }
 
   resumingContexts.push(context);
   spawningProcedures.emplace(std::move(procedure));
 }
 
+void Dispatcher::setStackPoolLimit(std::size_t limit) {
+  stackPoolLimit = limit;
+}
+
+std::size_t Dispatcher::getLiveStackCount() const {
+  return contextCount;
+}
+
+std::size_t Dispatcher::getPeakStackCount() const {
+  return peakContextCount;
+}
+
 void Dispatcher::clear() {
 //TODO
 }
@@ -106,8 +198,26 @@ void Dispatcher::yield() {
       break;
     }
 
+    uint64_t now = getCurrentTick();
+    timerWheel.advance(now, [this](TimerWheel::Entry* entry) {
+      resumingContexts.push(entry->context);
+    });
+
+    if (!resumingContexts.empty()) {
+      continue;
+    }
+
+    int timeout = -1;
+    uint64_t nextTick;
+    if (timerWheel.getNextTick(nextTick)) {
+      timeout = static_cast<int>(std::min<uint64_t>(nextTick - now, INT_MAX));
+    }
+
     epoll_event event;
-    int count = epoll_wait(epoll, &event, 1, -1);
+    int count = epoll_wait(epoll, &event, 1, timeout);
+    if (count == 0) {
+      continue;
+    }
 
     if (count == 1) {
       if ((event.events & EPOLLOUT) != 0) {
@@ -132,17 +242,40 @@ void Dispatcher::yield() {
       std::cerr << "swapcontext() failed, errno=" << errno << std::endl;
       throw std::runtime_error("Dispatcher::yield()");
     }
+
+    releaseRetiredContexts();
   }
 }
 
+void Dispatcher::releaseRetiredContexts() {
+  for (void* context : retiredContexts) {
+    assert(context != currentContext);
+    freeStackContext(static_cast<StackContext*>(context));
+    --contextCount;
+  }
+
+  retiredContexts.clear();
+}
+
 void Dispatcher::contextProcedure() {
   void* context = currentContext;
+  std::size_t stackSize = static_cast<StackContext*>(context)->stackSize;
   for (;;) {
     assert(!spawningProcedures.empty());
-    std::function<void()> procedure = std::move(spawningProcedures.front());
-    spawningProcedures.pop();
-    procedure();
-    reusableContexts.push(context);
+    {
+      std::function<void()> procedure = std::move(spawningProcedures.front());
+      spawningProcedures.pop();
+      procedure();
+    }
+
+    std::stack<void*>& pool = reusableContexts[stackSize];
+    if (pool.size() < stackPoolLimit) {
+      pool.push(context);
+    } else {
+      //over the high-water mark, the stack is unmapped by the next context that runs
+      retiredContexts.push_back(context);
+    }
+
     yield();
   }
 }
@@ -201,7 +201,7 @@ size_t TcpConnection::read(uint8_t* data, size_t size) {
   return transferred;
 }
 
-void TcpConnection::write(const uint8_t* data, size_t size) {
+size_t TcpConnection::write(const uint8_t* data, size_t size) {
   assert(dispatcher != nullptr);
   assert(context == nullptr || static_cast<Dispatcher::ContextExt*>(context)->writeContext == nullptr);
   if (stopped) {
@@ -214,7 +214,7 @@ void TcpConnection::write(const uint8_t* data, size_t size) {
       throw std::runtime_error("TcpConnection::write");
     }
 
-    return;
+    return 0;
   }
 
   ssize_t transferred = ::send(connection, (void *)data, size, 0);
@@ -274,12 +274,15 @@ void TcpConnection::write(const uint8_t* data, size_t size) {
             throw std::runtime_error("send transferred 0 bytes.");
           }
 
-          assert(transferred == size);
-          return;
+          assert(transferred <= size);
+          return transferred;
         }
       }
     }
 
     throw std::runtime_error("TcpConnection::write");
   }
+
+  assert(transferred <= size);
+  return transferred;
 }
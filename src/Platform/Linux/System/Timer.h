@@ -26,7 +26,6 @@ public:
 
 private:
   Dispatcher* dispatcher;
-  int timer;
   bool stopped;
   void* context;
 };
@@ -0,0 +1,148 @@
+// Copyright (c) 2011-2015 The Cryptonote developers
+// Copyright (c) 2014-2015 XDN developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "TimerWheel.h"
+#include <cassert>
+
+using namespace System;
+
+namespace {
+
+//distance (1..64) from position to the next occupied slot, wrapping around; 0 if no slot is occupied
+unsigned nextSlotDistance(uint64_t occupied, unsigned position) {
+  if (occupied == 0) {
+    return 0;
+  }
+
+  unsigned shift = (position + 1) & 63;
+  uint64_t rotated = shift == 0 ? occupied : (occupied >> shift) | (occupied << (64 - shift));
+  return static_cast<unsigned>(__builtin_ctzll(rotated)) + 1;
+}
+
+}
+
+TimerWheel::TimerWheel(uint64_t tick) : currentTick(tick), count(0) {
+  occupied.fill(0);
+  for (auto& level : slots) {
+    level.fill(nullptr);
+  }
+}
+
+void TimerWheel::insert(Entry* entry, uint64_t expireTick) {
+  //the current tick has already been processed
+  entry->expireTick = expireTick > currentTick ? expireTick : currentTick + 1;
+  entry->armed = true;
+  place(entry);
+  ++count;
+}
+
+void TimerWheel::remove(Entry* entry) {
+  assert(entry->armed);
+  if (entry->prev != nullptr) {
+    entry->prev->next = entry->next;
+  } else {
+    slots[entry->level][entry->slot] = entry->next;
+    if (entry->next == nullptr) {
+      occupied[entry->level] &= ~(uint64_t(1) << entry->slot);
+    }
+  }
+
+  if (entry->next != nullptr) {
+    entry->next->prev = entry->prev;
+  }
+
+  entry->armed = false;
+  --count;
+}
+
+std::size_t TimerWheel::size() const {
+  return count;
+}
+
+bool TimerWheel::getNextTick(uint64_t& tick) const {
+  if (count == 0) {
+    return false;
+  }
+
+  bool found = false;
+  for (unsigned level = 0; level < LEVEL_COUNT; ++level) {
+    unsigned shift = level * LEVEL_BITS;
+    uint64_t block = currentTick >> shift;
+    unsigned distance = nextSlotDistance(occupied[level], static_cast<unsigned>(block & (LEVEL_SIZE - 1)));
+    if (distance != 0) {
+      //level 0 slots expire at that tick, higher level slots cascade when their block starts
+      uint64_t candidate = (block + distance) << shift;
+      if (!found || candidate < tick) {
+        tick = candidate;
+        found = true;
+      }
+    }
+  }
+
+  assert(found);
+  return found;
+}
+
+void TimerWheel::place(Entry* entry) {
+  assert(entry->expireTick >= currentTick);
+  uint64_t delta = entry->expireTick - currentTick;
+  for (unsigned level = 0; level < LEVEL_COUNT; ++level) {
+    unsigned shift = level * LEVEL_BITS;
+    if (delta < (uint64_t(1) << (shift + LEVEL_BITS))) {
+      link(entry, level, static_cast<unsigned>((entry->expireTick >> shift) & (LEVEL_SIZE - 1)));
+      return;
+    }
+  }
+
+  //beyond the wheel range: park in the farthest top level slot, it is placed again when that slot cascades
+  unsigned shift = (LEVEL_COUNT - 1) * LEVEL_BITS;
+  uint64_t parkTick = currentTick + (uint64_t(1) << (shift + LEVEL_BITS)) - 1;
+  link(entry, LEVEL_COUNT - 1, static_cast<unsigned>((parkTick >> shift) & (LEVEL_SIZE - 1)));
+}
+
+void TimerWheel::link(Entry* entry, unsigned level, unsigned slot) {
+  Entry*& head = slots[level][slot];
+  entry->level = static_cast<uint8_t>(level);
+  entry->slot = static_cast<uint8_t>(slot);
+  entry->prev = nullptr;
+  entry->next = head;
+  if (head != nullptr) {
+    head->prev = entry;
+  }
+
+  head = entry;
+  occupied[level] |= uint64_t(1) << slot;
+}
+
+TimerWheel::Entry* TimerWheel::detachSlot(unsigned level, unsigned slot) {
+  Entry* head = slots[level][slot];
+  slots[level][slot] = nullptr;
+  occupied[level] &= ~(uint64_t(1) << slot);
+  return head;
+}
+
+TimerWheel::Entry* TimerWheel::processTick() {
+  for (unsigned level = 1; level < LEVEL_COUNT; ++level) {
+    unsigned shift = level * LEVEL_BITS;
+    if ((currentTick & ((uint64_t(1) << shift) - 1)) != 0) {
+      break;
+    }
+
+    for (Entry* entry = detachSlot(level, static_cast<unsigned>((currentTick >> shift) & (LEVEL_SIZE - 1))); entry != nullptr;) {
+      Entry* next = entry->next;
+      place(entry);
+      entry = next;
+    }
+  }
+
+  Entry* expired = detachSlot(0, static_cast<unsigned>(currentTick & (LEVEL_SIZE - 1)));
+  for (Entry* entry = expired; entry != nullptr; entry = entry->next) {
+    assert(entry->expireTick == currentTick);
+    entry->armed = false;
+    --count;
+  }
+
+  return expired;
+}
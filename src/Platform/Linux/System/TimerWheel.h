@@ -0,0 +1,81 @@
+// Copyright (c) 2011-2015 The Cryptonote developers
+// Copyright (c) 2014-2015 XDN developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+namespace System {
+
+// Hierarchical timer wheel with 1 ms ticks: 4 levels of 64 slots cover ~4.6 hours directly,
+// longer timeouts are re-cascaded from the top level. Insert and remove are O(1); entries are
+// intrusive and owned by the caller.
+class TimerWheel {
+public:
+  struct Entry {
+    Entry* prev;
+    Entry* next;
+    uint64_t expireTick;
+    uint8_t level;
+    uint8_t slot;
+    bool armed;
+    void* context;
+  };
+
+  explicit TimerWheel(uint64_t tick);
+  TimerWheel(const TimerWheel&) = delete;
+  TimerWheel& operator=(const TimerWheel&) = delete;
+
+  void insert(Entry* entry, uint64_t expireTick);
+  void remove(Entry* entry);
+  std::size_t size() const;
+
+  // Earliest tick at which advance() has work to do (an expiry or a cascade); false if nothing is armed
+  bool getNextTick(uint64_t& tick) const;
+
+  // Moves the wheel to the given tick, unlinking expired entries and passing each to handler
+  template<typename Handler>
+  void advance(uint64_t tick, Handler handler);
+
+private:
+  static const unsigned LEVEL_BITS = 6;
+  static const unsigned LEVEL_SIZE = 1 << LEVEL_BITS;
+  static const unsigned LEVEL_COUNT = 4;
+
+  void place(Entry* entry);
+  void link(Entry* entry, unsigned level, unsigned slot);
+  Entry* detachSlot(unsigned level, unsigned slot);
+  Entry* processTick();
+
+  uint64_t currentTick;
+  std::size_t count;
+  std::array<uint64_t, LEVEL_COUNT> occupied;
+  std::array<std::array<Entry*, LEVEL_SIZE>, LEVEL_COUNT> slots;
+};
+
+template<typename Handler>
+void TimerWheel::advance(uint64_t tick, Handler handler) {
+  for (;;) {
+    uint64_t nextTick;
+    if (!getNextTick(nextTick) || nextTick > tick) {
+      if (tick > currentTick) {
+        currentTick = tick;
+      }
+
+      break;
+    }
+
+    currentTick = nextTick;
+    for (Entry* entry = processTick(); entry != nullptr;) {
+      Entry* next = entry->next;
+      handler(entry);
+      entry = next;
+    }
+  }
+}
+
+}
@@ -10,11 +10,63 @@
 #include <unistd.h>
 #include <sys/types.h>
 #include <sys/event.h>
+#include <sys/mman.h>
 #include <assert.h>
 #include <sys/time.h>
 
 using namespace System;
 
+namespace {
+
+struct StackContext {
+  ucontext_t context; //must be first, contexts are passed around as ucontext_t*
+  uint8_t* mapping;
+  std::size_t mappingSize;
+  std::size_t stackSize;
+};
+
+std::size_t getStackSizeClass(std::size_t stackSize) {
+  std::size_t sizeClass = Dispatcher::MIN_STACK_SIZE;
+  while (sizeClass < stackSize) {
+    sizeClass <<= 1;
+  }
+
+  return sizeClass;
+}
+
+//stack grows down, so the guard page is placed below it and an overflow faults instead of corrupting the neighbour
+StackContext* allocateStackContext(std::size_t stackSize) {
+  std::size_t pageSize = static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+  std::size_t mappingSize = stackSize + pageSize;
+  void* mapping = mmap(nullptr, mappingSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANON, -1, 0);
+  if (mapping == MAP_FAILED) {
+    std::cerr << "mmap() fail errno=" << errno << std::endl;
+    throw std::runtime_error("Dispatcher::spawn()");
+  }
+
+  if (mprotect(mapping, pageSize, PROT_NONE) == -1) {
+    std::cerr << "mprotect() fail errno=" << errno << std::endl;
+    munmap(mapping, mappingSize);
+    throw std::runtime_error("Dispatcher::spawn()");
+  }
+
+  StackContext* context = new StackContext;
+  context->mapping = static_cast<uint8_t*>(mapping);
+  context->mappingSize = mappingSize;
+  context->stackSize = stackSize;
+  return context;
+}
+
+void freeStackContext(StackContext* context) {
+  if (munmap(context->mapping, context->mappingSize) == -1) {
+    std::cerr << "munmap() fail errno=" << errno << std::endl;
+  }
+
+  delete context;
+}
+
+}
+
 void Dispatcher::contextProcedureStatic(void *context) {
   reinterpret_cast<Dispatcher*>(context)->contextProcedure();
 }
@@ -29,6 +81,8 @@ Dispatcher::Dispatcher() : lastCreatedTimer(0) {
       std::cerr << "getcontext() fail errno=" << errno << std::endl;
     } else {
       contextCount = 0;
+      peakContextCount = 0;
+      stackPoolLimit = DEFAULT_STACK_POOL_LIMIT;
       return;
     }
   }
@@ -37,16 +91,18 @@ Dispatcher::Dispatcher() : lastCreatedTimer(0) {
 
 Dispatcher::~Dispatcher() {
   assert(resumingContexts.empty());
-  assert(reusableContexts.size() == contextCount);
   assert(spawningProcedures.empty());
-  assert(reusableContexts.size() == allocatedStacks.size());
-  while (!reusableContexts.empty()) {
-    delete[] allocatedStacks.top();
-    allocatedStacks.pop();
-    delete   static_cast<ucontext_t*>(reusableContexts.top());
-    reusableContexts.pop();
+  releaseRetiredContexts();
+  for (auto& pool : reusableContexts) {
+    while (!pool.second.empty()) {
+      freeStackContext(static_cast<StackContext*>(pool.second.top()));
+      pool.second.pop();
+      --contextCount;
+    }
   }
 
+  assert(contextCount == 0);
+
   while (!timers.empty()) {
     timers.pop();
   }
@@ -69,28 +125,49 @@ void Dispatcher::pushContext(void* context) {
 }
 
 void Dispatcher::spawn(std::function<void()>&& procedure) {
+  spawn(std::move(procedure), DEFAULT_STACK_SIZE);
+}
+
+void Dispatcher::spawn(std::function<void()>&& procedure, std::size_t stackSize) {
+  releaseRetiredContexts();
+  stackSize = getStackSizeClass(stackSize);
+  std::stack<void*>& pool = reusableContexts[stackSize];
   void* context;
-  if (reusableContexts.empty()) {
-    context = new ucontext_t;
+  if (pool.empty()) {
+    StackContext* stackContext = allocateStackContext(stackSize);
+    context = &stackContext->context;
     if (-1 == getcontext(reinterpret_cast<ucontext_t *>(context))) { //makecontext precondition
       std::cerr << "getcontext() fail errno=" << errno << std::endl;
+      freeStackContext(stackContext);
       throw std::runtime_error("Dispatcher::spawn()");
     }
-    auto stackPointer = new uint8_t[64 * 1024];
-    reinterpret_cast<ucontext_t *>(context)->uc_stack.ss_sp = stackPointer;
-    allocatedStacks.push(stackPointer);
-    reinterpret_cast<ucontext_t *>(context)->uc_stack.ss_size = 64 * 1024;
+    reinterpret_cast<ucontext_t *>(context)->uc_stack.ss_sp = stackContext->mapping + (stackContext->mappingSize - stackSize);
+    reinterpret_cast<ucontext_t *>(context)->uc_stack.ss_size = stackSize;
     makecontext(reinterpret_cast<ucontext_t *>(context), (void(*)())contextProcedureStatic, 1, reinterpret_cast<int*>(this));
-    ++contextCount;
+    if (++contextCount > peakContextCount) {
+      peakContextCount = contextCount;
+    }
   } else {
-    context = reusableContexts.top();
-    reusableContexts.pop();
+    context = pool.top();
+    pool.pop();
   }
 
   resumingContexts.push(context);
   spawningProcedures.emplace(std::move(procedure));
 }
 
+void Dispatcher::setStackPoolLimit(std::size_t limit) {
+  stackPoolLimit = limit;
+}
+
+std::size_t Dispatcher::getLiveStackCount() const {
+  return contextCount;
+}
+
+std::size_t Dispatcher::getPeakStackCount() const {
+  return peakContextCount;
+}
+
 int Dispatcher::getTimer() {
   int timer;
   if (timers.empty()) {
@@ -141,17 +218,40 @@ void Dispatcher::yield() {
       std::cerr << "setcontext() failed, errno=" << errno << std::endl;
       throw std::runtime_error("Dispatcher::yield()");
     }
+
+    releaseRetiredContexts();
   }
 }
 
+void Dispatcher::releaseRetiredContexts() {
+  for (void* context : retiredContexts) {
+    assert(context != currentContext);
+    freeStackContext(static_cast<StackContext*>(context));
+    --contextCount;
+  }
+
+  retiredContexts.clear();
+}
+
 void Dispatcher::contextProcedure() {
   void* context = currentContext;
+  std::size_t stackSize = static_cast<StackContext*>(context)->stackSize;
   for (;;) {
     assert(!spawningProcedures.empty());
-    std::function<void()> procedure = std::move(spawningProcedures.front());
-    spawningProcedures.pop();
-    procedure();
-    reusableContexts.push(context);
+    {
+      std::function<void()> procedure = std::move(spawningProcedures.front());
+      spawningProcedures.pop();
+      procedure();
+    }
+
+    std::stack<void*>& pool = reusableContexts[stackSize];
+    if (pool.size() < stackPoolLimit) {
+      pool.push(context);
+    } else {
+      //over the high-water mark, the stack is unmapped by the next context that runs
+      retiredContexts.push_back(context);
+    }
+
     yield();
   }
 }
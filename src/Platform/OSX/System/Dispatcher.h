@@ -6,8 +6,10 @@
 #pragma once
 
 #include <functional>
+#include <map>
 #include <queue>
 #include <stack>
+#include <vector>
 
 namespace System {
 
@@ -18,8 +20,19 @@ public:
   ~Dispatcher();
   Dispatcher& operator=(const Dispatcher&) = delete;
   void spawn(std::function<void()>&& procedure);
+  // stackSize is rounded up to a power-of-two size class, at least MIN_STACK_SIZE
+  void spawn(std::function<void()>&& procedure, std::size_t stackSize);
   void yield();
   void clear();
+
+  static const std::size_t DEFAULT_STACK_SIZE = 64 * 1024;
+  static const std::size_t MIN_STACK_SIZE = 16 * 1024;
+  static const std::size_t DEFAULT_STACK_POOL_LIMIT = 256;
+
+  // Maximum number of finished contexts kept for reuse per stack size class; the rest are unmapped
+  void setStackPoolLimit(std::size_t limit);
+  std::size_t getLiveStackCount() const;
+  std::size_t getPeakStackCount() const;
   
   struct ContextExt {
     void *context;
@@ -35,9 +48,11 @@ private:
   void* currentContext;
   int lastCreatedTimer;
   std::size_t contextCount;
+  std::size_t peakContextCount;
+  std::size_t stackPoolLimit;
   std::queue<void*> resumingContexts;
-  std::stack<void*> reusableContexts;
-  std::stack<uint8_t *> allocatedStacks;
+  std::map<std::size_t, std::stack<void*>> reusableContexts;
+  std::vector<void*> retiredContexts;
   std::queue<std::function<void()>> spawningProcedures;
   std::stack<int> timers;
   
@@ -47,6 +62,7 @@ private:
   void pushContext(void* context);
   void* getCurrentContext() const;
   
+  void releaseRetiredContexts();
   void contextProcedure();
   static void contextProcedureStatic(void* context);
 };
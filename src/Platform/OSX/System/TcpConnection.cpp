@@ -138,7 +138,7 @@ size_t TcpConnection::read(uint8_t* data, size_t size) {
   return transferred;
 }
 
-void TcpConnection::write(const uint8_t* data, size_t size) {
+size_t TcpConnection::write(const uint8_t* data, size_t size) {
   assert(dispatcher != nullptr);
   assert(writeContext == nullptr);
   if (stopped) {
@@ -151,7 +151,7 @@ void TcpConnection::write(const uint8_t* data, size_t size) {
       throw std::runtime_error("TcpConnection::write");
     }
 
-    return;
+    return 0;
   }
 
   ssize_t transferred = ::send(connection, (void *)data, size, 0);
@@ -186,14 +186,17 @@ void TcpConnection::write(const uint8_t* data, size_t size) {
             throw std::runtime_error("send transferred 0 bytes.");
           }
 
-          assert(transferred == size);
-          return;
+          assert(transferred <= size);
+          return transferred;
         }
       }
     }
 
     throw std::runtime_error("TcpConnection::write");
   }
+
+  assert(transferred <= size);
+  return transferred;
 }
 
 void TcpConnection::stop() {
@@ -23,7 +23,7 @@ public:
   void start();
   void stop();
   std::size_t read(uint8_t* data, std::size_t size);
-  void write(const uint8_t* data, std::size_t size);
+  std::size_t write(const uint8_t* data, std::size_t size);
 
 private:
   friend class TcpConnector;
@@ -18,6 +18,15 @@ struct OverlappedExt : public OVERLAPPED {
   void* context;
 };
 
+std::size_t getStackSizeClass(std::size_t stackSize) {
+  std::size_t sizeClass = System::Dispatcher::MIN_STACK_SIZE;
+  while (sizeClass < stackSize) {
+    sizeClass <<= 1;
+  }
+
+  return sizeClass;
+}
+
 }
 
 Dispatcher::Dispatcher() {
@@ -34,6 +43,8 @@ Dispatcher::Dispatcher() {
         std::cerr << "WSAStartup failed, result=" << result << '.' << std::endl;
       } else {
         contextCount = 0;
+        peakContextCount = 0;
+        stackPoolLimit = DEFAULT_STACK_POOL_LIMIT;
         return;
       }
 
@@ -52,13 +63,18 @@ Dispatcher::Dispatcher() {
 
 Dispatcher::~Dispatcher() {
   assert(resumingContexts.empty());
-  assert(reusableContexts.size() == contextCount);
   assert(spawningProcedures.empty());
-  while (!reusableContexts.empty()) {
-    DeleteFiber(reusableContexts.top());
-    reusableContexts.pop();
+  releaseRetiredContexts();
+  for (auto& pool : reusableContexts) {
+    while (!pool.second.empty()) {
+      DeleteFiber(pool.second.top());
+      pool.second.pop();
+      --contextCount;
+    }
   }
 
+  assert(contextCount == 0);
+
   while (!timers.empty()) {
     if (CloseHandle(timers.top()) != TRUE) {
       std::cerr << "CloseHandle failed, result=" << GetLastError() << '.' << std::endl;
@@ -109,23 +125,46 @@ void Dispatcher::pushContext(void* context) {
 }
 
 void Dispatcher::spawn(std::function<void()>&& procedure) {
+  spawn(std::move(procedure), DEFAULT_STACK_SIZE);
+}
+
+void Dispatcher::spawn(std::function<void()>&& procedure, std::size_t stackSize) {
+  releaseRetiredContexts();
+  stackSize = getStackSizeClass(stackSize);
+  std::stack<void*>& pool = reusableContexts[stackSize];
   void* context;
-  if (reusableContexts.empty()) {
-    context = CreateFiberEx(16384, 65536, 0, contextProcedureStatic, this);
+  if (pool.empty()) {
+    //fiber stacks are reserved with a guard page by the system
+    context = CreateFiberEx(MIN_STACK_SIZE, stackSize, 0, contextProcedureStatic, this);
     if (context == NULL) {
       std::cerr << "CreateFiberEx failed, result=" << GetLastError() << '.' << std::endl;
       throw std::runtime_error("Dispatcher::spawn");
     }
-    ++contextCount;
+    contextStackSizes[context] = stackSize;
+    if (++contextCount > peakContextCount) {
+      peakContextCount = contextCount;
+    }
   } else {
-    context = reusableContexts.top();
-    reusableContexts.pop();
+    context = pool.top();
+    pool.pop();
   }
 
   resumingContexts.push(context);
   spawningProcedures.emplace(std::move(procedure));
 }
 
+void Dispatcher::setStackPoolLimit(std::size_t limit) {
+  stackPoolLimit = limit;
+}
+
+std::size_t Dispatcher::getLiveStackCount() const {
+  return contextCount;
+}
+
+std::size_t Dispatcher::getPeakStackCount() const {
+  return peakContextCount;
+}
+
 void Dispatcher::clear() {
 //TODO
 }
@@ -155,16 +194,40 @@ void Dispatcher::yield() {
 
   if (context != GetCurrentFiber()) {
     SwitchToFiber(context);
+    releaseRetiredContexts();
+  }
+}
+
+void Dispatcher::releaseRetiredContexts() {
+  for (void* context : retiredContexts) {
+    assert(context != GetCurrentFiber());
+    contextStackSizes.erase(context);
+    DeleteFiber(context);
+    --contextCount;
   }
+
+  retiredContexts.clear();
 }
 
 void Dispatcher::contextProcedure() {
+  void* context = GetCurrentFiber();
+  std::size_t stackSize = contextStackSizes[context];
   for (;;) {
     assert(!spawningProcedures.empty());
-    std::function<void()> procedure = std::move(spawningProcedures.front());
-    spawningProcedures.pop();
-    procedure();
-    reusableContexts.push(GetCurrentFiber());
+    {
+      std::function<void()> procedure = std::move(spawningProcedures.front());
+      spawningProcedures.pop();
+      procedure();
+    }
+
+    std::stack<void*>& pool = reusableContexts[stackSize];
+    if (pool.size() < stackPoolLimit) {
+      pool.push(context);
+    } else {
+      //over the high-water mark, the fiber is deleted by the next context that runs
+      retiredContexts.push_back(context);
+    }
+
     yield();
   }
 }
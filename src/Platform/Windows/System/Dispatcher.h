@@ -6,8 +6,10 @@
 #pragma once
 
 #include <functional>
+#include <map>
 #include <queue>
 #include <stack>
+#include <vector>
 
 namespace System {
 
@@ -18,9 +20,20 @@ public:
   ~Dispatcher();
   Dispatcher& operator=(const Dispatcher&) = delete;
   void spawn(std::function<void()>&& procedure);
+  // stackSize is rounded up to a power-of-two size class, at least MIN_STACK_SIZE
+  void spawn(std::function<void()>&& procedure, std::size_t stackSize);
   void yield();
   void clear();
 
+  static const std::size_t DEFAULT_STACK_SIZE = 64 * 1024;
+  static const std::size_t MIN_STACK_SIZE = 16 * 1024;
+  static const std::size_t DEFAULT_STACK_POOL_LIMIT = 256;
+
+  // Maximum number of finished contexts kept for reuse per stack size class; the rest are deleted
+  void setStackPoolLimit(std::size_t limit);
+  std::size_t getLiveStackCount() const;
+  std::size_t getPeakStackCount() const;
+
 private:
   friend class Event;
   friend class DispatcherAccessor;
@@ -31,8 +44,12 @@ private:
 
   void* completionPort;
   std::size_t contextCount;
+  std::size_t peakContextCount;
+  std::size_t stackPoolLimit;
   std::queue<void*> resumingContexts;
-  std::stack<void*> reusableContexts;
+  std::map<std::size_t, std::stack<void*>> reusableContexts;
+  std::map<void*, std::size_t> contextStackSizes;
+  std::vector<void*> retiredContexts;
   std::queue<std::function<void()>> spawningProcedures;
   std::stack<void*> timers;
 
@@ -41,6 +58,7 @@ private:
   void pushTimer(void* timer);
   void pushContext(void* context);
 
+  void releaseRetiredContexts();
   void contextProcedure();
   static void __stdcall contextProcedureStatic(void* context);
 };
@@ -163,7 +163,7 @@ size_t TcpConnection::read(uint8_t* data, size_t size) {
   return transferred;
 }
 
-void TcpConnection::write(const uint8_t* data, size_t size) {
+size_t TcpConnection::write(const uint8_t* data, size_t size) {
   assert(dispatcher != nullptr);
   assert(context == nullptr || static_cast<Context*>(context)->write == nullptr);
   if (stopped) {
@@ -176,7 +176,7 @@ void TcpConnection::write(const uint8_t* data, size_t size) {
       throw std::runtime_error("TcpConnection::write");
     }
 
-    return;
+    return 0;
   }
 
   WSABUF buf{static_cast<ULONG>(size), reinterpret_cast<char*>(const_cast<uint8_t*>(data))};
@@ -223,6 +223,7 @@ void TcpConnection::write(const uint8_t* data, size_t size) {
     throw std::runtime_error("TcpConnection::write");
   }
 
-  assert(transferred == size);
+  assert(transferred <= size);
   assert(flags == 0);
+  return transferred;
 }
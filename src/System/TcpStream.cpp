@@ -5,27 +5,46 @@
 
 #include "TcpStream.h"
 
+#include <algorithm>
+#include <cassert>
 #include <cstring>
 
 using namespace System;
 
-TcpStreambuf::TcpStreambuf(TcpConnection& connection) : connection(connection) {
+TcpStreambuf::TcpStreambuf(TcpConnection& connection, std::size_t readBufferSize, std::size_t writeBufferSize, std::size_t writeBufferLimit) :
+  connection(connection), readBuf(std::max<std::size_t>(readBufferSize, 1)), writeBuf(std::max<std::size_t>(writeBufferSize, 1)),
+  writeBufLimit(std::max(writeBufferLimit, writeBuf.size())) {
   setg(&readBuf.front(), &readBuf.front(), &readBuf.front());
-  setp(reinterpret_cast<char*>(&writeBuf.front()), reinterpret_cast<char *>(&writeBuf.front() + writeBuf.max_size()));
+  setp(reinterpret_cast<char*>(&writeBuf.front()), reinterpret_cast<char*>(&writeBuf.front() + writeBuf.size()));
 }
 
 TcpStreambuf::~TcpStreambuf() {
   dumpBuffer();
 }
 
+bool TcpStreambuf::peek(const char*& data, std::size_t& size) {
+  if (gptr() == egptr() && traits_type::eq_int_type(underflow(), traits_type::eof())) {
+    return false;
+  }
+
+  data = gptr();
+  size = egptr() - gptr();
+  return true;
+}
+
+void TcpStreambuf::consume(std::size_t size) {
+  assert(size <= static_cast<std::size_t>(egptr() - gptr()));
+  gbump(static_cast<int>(size));
+}
+
 std::streambuf::int_type TcpStreambuf::underflow() {
   if (gptr() < egptr())
     return traits_type::to_int_type(*gptr());
 
   size_t bytesRead;
   try {
-    bytesRead = connection.read(reinterpret_cast<uint8_t*>(&readBuf.front()), readBuf.max_size());
-  } catch (std::exception& ex) {
+    bytesRead = connection.read(reinterpret_cast<uint8_t*>(&readBuf.front()), readBuf.size());
+  } catch (std::exception&) {
     return traits_type::eof();
   }
 
@@ -38,15 +57,75 @@ std::streambuf::int_type TcpStreambuf::underflow() {
   return traits_type::to_int_type(*gptr());
 }
 
+std::streamsize TcpStreambuf::xsgetn(char* s, std::streamsize n) {
+  std::streamsize total = 0;
+  while (total < n) {
+    std::size_t remaining = static_cast<std::size_t>(n - total);
+    std::size_t available = egptr() - gptr();
+    if (available > 0) {
+      std::size_t count = std::min(available, remaining);
+      std::memcpy(s + total, gptr(), count);
+      gbump(static_cast<int>(count));
+      total += count;
+      continue;
+    }
+
+    if (remaining >= readBuf.size()) {
+      //bulk reads go straight into the caller buffer
+      size_t bytesRead;
+      try {
+        bytesRead = connection.read(reinterpret_cast<uint8_t*>(s + total), remaining);
+      } catch (std::exception&) {
+        break;
+      }
+
+      if (bytesRead == 0) {
+        break;
+      }
+
+      total += bytesRead;
+    } else if (traits_type::eq_int_type(underflow(), traits_type::eof())) {
+      break;
+    }
+  }
+
+  return total;
+}
+
 int TcpStreambuf::sync() {
   return dumpBuffer() ? 0 : -1;
 }
 
 bool TcpStreambuf::dumpBuffer() {
+  size_t count = pptr() - pbase();
+  if (count == 0) {
+    return true;
+  }
+
+  bool result = writeAll(&writeBuf.front(), count);
+  setp(reinterpret_cast<char*>(&writeBuf.front()), reinterpret_cast<char*>(&writeBuf.front() + writeBuf.size()));
+  return result;
+}
+
+bool TcpStreambuf::growBuffer(std::size_t required) {
+  if (required > writeBufLimit) {
+    return false;
+  }
+
+  size_t count = pptr() - pbase();
+  writeBuf.resize(std::min(std::max(writeBuf.size() * 2, required), writeBufLimit));
+  setp(reinterpret_cast<char*>(&writeBuf.front()), reinterpret_cast<char*>(&writeBuf.front() + writeBuf.size()));
+  pbump(static_cast<int>(count));
+  return true;
+}
+
+bool TcpStreambuf::writeAll(const uint8_t* data, std::size_t size) {
   try {
-    size_t count = pptr() - pbase();
-    connection.write(&writeBuf.front(), count);
-    pbump(-count);
+    while (size > 0) {
+      size_t transferred = connection.write(data, size);
+      data += transferred;
+      size -= transferred;
+    }
   } catch (std::exception&) {
     return false;
   }
@@ -60,7 +139,7 @@ std::streambuf::int_type TcpStreambuf::overflow(std::streambuf::int_type ch) {
   }
 
   if (pptr() == epptr()) {
-    if (!dumpBuffer()) {
+    if (!growBuffer(writeBuf.size() + 1) && !dumpBuffer()) {
       return traits_type::eof();
     }
   }
@@ -70,3 +149,26 @@ std::streambuf::int_type TcpStreambuf::overflow(std::streambuf::int_type ch) {
 
   return ch;
 }
+
+std::streamsize TcpStreambuf::xsputn(const char* s, std::streamsize n) {
+  std::size_t size = static_cast<std::size_t>(n);
+  std::size_t required = (pptr() - pbase()) + size;
+  if (required <= writeBuf.size() || growBuffer(required)) {
+    std::memcpy(pptr(), s, size);
+    pbump(static_cast<int>(size));
+    return n;
+  }
+
+  if (!dumpBuffer()) {
+    return 0;
+  }
+
+  if (size <= writeBuf.size()) {
+    std::memcpy(pptr(), s, size);
+    pbump(static_cast<int>(size));
+    return n;
+  }
+
+  //segment is larger than the buffer limit: send it right after the buffered header, without copying
+  return writeAll(reinterpret_cast<const uint8_t*>(s), size) ? n : 0;
+}
@@ -6,7 +6,7 @@
 #pragma once
 
 #include <streambuf>
-#include <array>
+#include <vector>
 
 #include <System/TcpConnection.h>
 
@@ -14,22 +14,39 @@ namespace System {
 
 class TcpStreambuf : public std::streambuf {
 public:
-  TcpStreambuf(TcpConnection& connection);
+  static const std::size_t DEFAULT_READ_BUFFER_SIZE = 16 * 1024;
+  static const std::size_t DEFAULT_WRITE_BUFFER_SIZE = 4 * 1024;
+  static const std::size_t DEFAULT_WRITE_BUFFER_LIMIT = 64 * 1024;
+
+  // Write buffer starts at writeBufferSize and doubles on overflow until writeBufferLimit,
+  // so a whole request or response normally leaves in a single send.
+  TcpStreambuf(TcpConnection& connection, std::size_t readBufferSize = DEFAULT_READ_BUFFER_SIZE,
+    std::size_t writeBufferSize = DEFAULT_WRITE_BUFFER_SIZE, std::size_t writeBufferLimit = DEFAULT_WRITE_BUFFER_LIMIT);
   TcpStreambuf(const TcpStreambuf&) = delete;
 
   virtual ~TcpStreambuf();
 
+  // Zero-copy read path: lends a view of the buffered input (receiving more if it is empty).
+  // Returns false on end of stream. The view stays valid until the next read operation.
+  bool peek(const char*& data, std::size_t& size);
+  void consume(std::size_t size);
+
 private:
   std::streambuf::int_type underflow() override;
   std::streambuf::int_type overflow(std::streambuf::int_type ch) override;
+  std::streamsize xsgetn(char* s, std::streamsize n) override;
+  std::streamsize xsputn(const char* s, std::streamsize n) override;
   int sync() override;
 
   bool dumpBuffer();
+  bool growBuffer(std::size_t required);
+  bool writeAll(const uint8_t* data, std::size_t size);
 
   TcpConnection& connection;
 
-  std::array<char, 4096> readBuf;
-  std::array<uint8_t, /*1024*/ 16> writeBuf;
+  std::vector<char> readBuf;
+  std::vector<uint8_t> writeBuf;
+  std::size_t writeBufLimit;
 };
 
 }
@@ -4,6 +4,7 @@
 // file COPYING or http://www.opensource.org/licenses/mit-license.php.
 
 #include <assert.h>
+#include <stddef.h>
 #include <stdint.h>
 
 #include "warnings.h"
@@ -42,6 +43,219 @@ static uint64_t load_4(const unsigned char *in)
   return result;
 }
 
+#if defined(CRYPTO_OPS_FE64)
+
+/* Field arithmetic on five 51-bit limbs, after curve25519-donna-c64 */
+
+/*
+Every function below leaves its output with limbs bounded by 2^52,
+and accepts any input bounded that way.
+*/
+
+__extension__ typedef unsigned __int128 uint128;
+
+static const uint64_t fe_mask51 = ((uint64_t) 1 << 51) - 1;
+
+static uint64_t load_8(const unsigned char *in) {
+  return load_4(in) | (load_4(in + 4) << 32);
+}
+
+static void store_8(unsigned char *out, uint64_t in) {
+  int i;
+  for (i = 0; i < 8; ++i) {
+    out[i] = (unsigned char) (in >> (8 * i));
+  }
+}
+
+static void fe_carry(fe h) {
+  h[1] += h[0] >> 51; h[0] &= fe_mask51;
+  h[2] += h[1] >> 51; h[1] &= fe_mask51;
+  h[3] += h[2] >> 51; h[2] &= fe_mask51;
+  h[4] += h[3] >> 51; h[3] &= fe_mask51;
+  h[0] += 19 * (h[4] >> 51); h[4] &= fe_mask51;
+}
+
+static void fe_carry_wide(fe h, uint128 r0, uint128 r1, uint128 r2, uint128 r3, uint128 r4) {
+  uint64_t h0;
+  r1 += (uint64_t) (r0 >> 51); h0 = (uint64_t) r0 & fe_mask51;
+  r2 += (uint64_t) (r1 >> 51); h[1] = (uint64_t) r1 & fe_mask51;
+  r3 += (uint64_t) (r2 >> 51); h[2] = (uint64_t) r2 & fe_mask51;
+  r4 += (uint64_t) (r3 >> 51); h[3] = (uint64_t) r3 & fe_mask51;
+  h0 += 19 * (uint64_t) (r4 >> 51); h[4] = (uint64_t) r4 & fe_mask51;
+  h[1] += h0 >> 51; h[0] = h0 & fe_mask51;
+}
+
+static void fe_0(fe h) {
+  h[0] = 0;
+  h[1] = 0;
+  h[2] = 0;
+  h[3] = 0;
+  h[4] = 0;
+}
+
+static void fe_1(fe h) {
+  h[0] = 1;
+  h[1] = 0;
+  h[2] = 0;
+  h[3] = 0;
+  h[4] = 0;
+}
+
+static void fe_add(fe h, const fe f, const fe g) {
+  h[0] = f[0] + g[0];
+  h[1] = f[1] + g[1];
+  h[2] = f[2] + g[2];
+  h[3] = f[3] + g[3];
+  h[4] = f[4] + g[4];
+  fe_carry(h);
+}
+
+/* 4 * p, added before subtracting so that no limb goes negative */
+static const uint64_t fe_four_p0 = 0x1fffffffffffb4;
+static const uint64_t fe_four_p = 0x1ffffffffffffc;
+
+static void fe_sub(fe h, const fe f, const fe g) {
+  h[0] = f[0] + fe_four_p0 - g[0];
+  h[1] = f[1] + fe_four_p - g[1];
+  h[2] = f[2] + fe_four_p - g[2];
+  h[3] = f[3] + fe_four_p - g[3];
+  h[4] = f[4] + fe_four_p - g[4];
+  fe_carry(h);
+}
+
+static void fe_neg(fe h, const fe f) {
+  h[0] = fe_four_p0 - f[0];
+  h[1] = fe_four_p - f[1];
+  h[2] = fe_four_p - f[2];
+  h[3] = fe_four_p - f[3];
+  h[4] = fe_four_p - f[4];
+  fe_carry(h);
+}
+
+/*
+Replace (f,g) with (g,g) if b == 1;
+replace (f,g) with (f,g) if b == 0.
+
+Preconditions: b in {0,1}.
+*/
+
+static void fe_cmov(fe f, const fe g, unsigned int b) {
+  uint64_t mask = (uint64_t) 0 - b;
+  f[0] ^= (f[0] ^ g[0]) & mask;
+  f[1] ^= (f[1] ^ g[1]) & mask;
+  f[2] ^= (f[2] ^ g[2]) & mask;
+  f[3] ^= (f[3] ^ g[3]) & mask;
+  f[4] ^= (f[4] ^ g[4]) & mask;
+}
+
+static void fe_copy(fe h, const fe f) {
+  h[0] = f[0];
+  h[1] = f[1];
+  h[2] = f[2];
+  h[3] = f[3];
+  h[4] = f[4];
+}
+
+static void fe_mul(fe h, const fe f, const fe g) {
+  uint64_t f0 = f[0], f1 = f[1], f2 = f[2], f3 = f[3], f4 = f[4];
+  uint64_t g0 = g[0], g1 = g[1], g2 = g[2], g3 = g[3], g4 = g[4];
+  uint64_t g1_19 = 19 * g1;
+  uint64_t g2_19 = 19 * g2;
+  uint64_t g3_19 = 19 * g3;
+  uint64_t g4_19 = 19 * g4;
+  uint128 r0 = (uint128) f0 * g0 + (uint128) f1 * g4_19 + (uint128) f2 * g3_19 + (uint128) f3 * g2_19 + (uint128) f4 * g1_19;
+  uint128 r1 = (uint128) f0 * g1 + (uint128) f1 * g0 + (uint128) f2 * g4_19 + (uint128) f3 * g3_19 + (uint128) f4 * g2_19;
+  uint128 r2 = (uint128) f0 * g2 + (uint128) f1 * g1 + (uint128) f2 * g0 + (uint128) f3 * g4_19 + (uint128) f4 * g3_19;
+  uint128 r3 = (uint128) f0 * g3 + (uint128) f1 * g2 + (uint128) f2 * g1 + (uint128) f3 * g0 + (uint128) f4 * g4_19;
+  uint128 r4 = (uint128) f0 * g4 + (uint128) f1 * g3 + (uint128) f2 * g2 + (uint128) f3 * g1 + (uint128) f4 * g0;
+  fe_carry_wide(h, r0, r1, r2, r3, r4);
+}
+
+static void fe_sq_wide(const fe f, uint128 *r0, uint128 *r1, uint128 *r2, uint128 *r3, uint128 *r4) {
+  uint64_t f0 = f[0], f1 = f[1], f2 = f[2], f3 = f[3], f4 = f[4];
+  uint64_t f0_2 = 2 * f0;
+  uint64_t f1_2 = 2 * f1;
+  uint64_t f1_38 = 38 * f1;
+  uint64_t f2_38 = 38 * f2;
+  uint64_t f3_19 = 19 * f3;
+  uint64_t f3_38 = 38 * f3;
+  uint64_t f4_19 = 19 * f4;
+  *r0 = (uint128) f0 * f0 + (uint128) f1_38 * f4 + (uint128) f2_38 * f3;
+  *r1 = (uint128) f0_2 * f1 + (uint128) f2_38 * f4 + (uint128) f3_19 * f3;
+  *r2 = (uint128) f0_2 * f2 + (uint128) f1 * f1 + (uint128) f3_38 * f4;
+  *r3 = (uint128) f0_2 * f3 + (uint128) f1_2 * f2 + (uint128) f4_19 * f4;
+  *r4 = (uint128) f0_2 * f4 + (uint128) f1_2 * f3 + (uint128) f2 * f2;
+}
+
+static void fe_sq(fe h, const fe f) {
+  uint128 r0, r1, r2, r3, r4;
+  fe_sq_wide(f, &r0, &r1, &r2, &r3, &r4);
+  fe_carry_wide(h, r0, r1, r2, r3, r4);
+}
+
+/*
+h = 2 * f * f
+*/
+
+static void fe_sq2(fe h, const fe f) {
+  uint128 r0, r1, r2, r3, r4;
+  fe_sq_wide(f, &r0, &r1, &r2, &r3, &r4);
+  fe_carry_wide(h, 2 * r0, 2 * r1, 2 * r2, 2 * r3, 2 * r4);
+}
+
+static void fe_tobytes(unsigned char *s, const fe h) {
+  uint64_t t[5];
+  fe_copy(t, h);
+  fe_carry(t);
+  fe_carry(t);
+  /* t is now below 2^255 with carried limbs, compute t mod p as (t + 19) - 2^255 when t + 19 reaches 2^255 */
+  t[0] += 19;
+  fe_carry(t);
+  t[0] += ((uint64_t) 1 << 51) - 19;
+  t[1] += ((uint64_t) 1 << 51) - 1;
+  t[2] += ((uint64_t) 1 << 51) - 1;
+  t[3] += ((uint64_t) 1 << 51) - 1;
+  t[4] += ((uint64_t) 1 << 51) - 1;
+  /* t + 2^255 - 19 is now in [2^255, 2^256 - 20], dropping its top bit leaves the canonical value */
+  t[1] += t[0] >> 51; t[0] &= fe_mask51;
+  t[2] += t[1] >> 51; t[1] &= fe_mask51;
+  t[3] += t[2] >> 51; t[2] &= fe_mask51;
+  t[4] += t[3] >> 51; t[3] &= fe_mask51;
+  t[4] &= fe_mask51;
+
+  store_8(s, t[0] | (t[1] << 51));
+  store_8(s + 8, (t[1] >> 13) | (t[2] << 38));
+  store_8(s + 16, (t[2] >> 26) | (t[3] << 25));
+  store_8(s + 24, (t[3] >> 39) | (t[4] << 12));
+}
+
+/* Loads the low 255 bits, fails if they are not below p */
+
+static int fe_frombytes_vartime(fe h, const unsigned char *s) {
+  h[0] = load_8(s) & fe_mask51;
+  h[1] = (load_8(s + 6) >> 3) & fe_mask51;
+  h[2] = (load_8(s + 12) >> 6) & fe_mask51;
+  h[3] = (load_8(s + 19) >> 1) & fe_mask51;
+  h[4] = (load_8(s + 24) >> 12) & fe_mask51;
+  if (h[4] == fe_mask51 && h[3] == fe_mask51 && h[2] == fe_mask51 && h[1] == fe_mask51 && h[0] >= fe_mask51 - 18) {
+    return -1;
+  }
+  return 0;
+}
+
+/* Loads all 256 bits, reduced */
+
+static void fe_frombytes_full(fe h, const unsigned char *s) {
+  h[0] = load_8(s) & fe_mask51;
+  h[1] = (load_8(s + 6) >> 3) & fe_mask51;
+  h[2] = (load_8(s + 12) >> 6) & fe_mask51;
+  h[3] = (load_8(s + 19) >> 1) & fe_mask51;
+  h[4] = load_8(s + 24) >> 12;
+  fe_carry(h);
+}
+
+#else
+
 /* From fe_0.c */
 
 /*
@@ -230,6 +444,8 @@ static void fe_copy(fe h, const fe f) {
   h[9] = f9;
 }
 
+#endif
+
 /* From fe_invert.c */
 
 static void fe_invert(fe out, const fe z) {
@@ -317,6 +533,8 @@ static int fe_isnonzero(const fe f) {
     s[27] | s[28] | s[29] | s[30] | s[31]) - 1) >> 8) + 1;
 }
 
+#if !defined(CRYPTO_OPS_FE64)
+
 /* From fe_mul.c */
 
 /*
@@ -1097,6 +1315,8 @@ static void fe_tobytes(unsigned char *s, const fe h) {
   s[31] = h9 >> 18;
 }
 
+#endif
+
 /* From ge_add.c */
 
 void ge_add(ge_p1p1 *r, const ge_p3 *p, const ge_cached *q) {
@@ -1116,7 +1336,9 @@ void ge_add(ge_p1p1 *r, const ge_p3 *p, const ge_cached *q) {
 
 /* From ge_double_scalarmult.c, modified */
 
-static void slide(signed char *r, const unsigned char *a) {
+/* Signed odd digits of at most max in absolute value, max is 15 for 8 precomputed points and 63 for 32 */
+
+static void slide(signed char *r, const unsigned char *a, int max) {
   int i;
   int b;
   int k;
@@ -1129,9 +1351,9 @@ static void slide(signed char *r, const unsigned char *a) {
     if (r[i]) {
       for (b = 1; b <= 6 && i + b < 256; ++b) {
         if (r[i + b]) {
-          if (r[i] + (r[i + b] << b) <= 15) {
+          if (r[i] + (r[i + b] << b) <= max) {
             r[i] += r[i + b] << b; r[i + b] = 0;
-          } else if (r[i] - (r[i + b] << b) >= -15) {
+          } else if (r[i] - (r[i + b] << b) >= -max) {
             r[i] -= r[i + b] << b;
             for (k = i + b; k < 256; ++k) {
               if (!r[k]) {
@@ -1167,6 +1389,7 @@ r = a * A + b * B
 where a = a[0]+256*a[1]+...+256^31 a[31].
 and b = b[0]+256*b[1]+...+256^31 b[31].
 B is the Ed25519 base point (x,4/5) with x positive.
+B is fixed, so it gets a wider window (B, 3B, ..., 63B) than A: about a quarter fewer additions.
 */
 
 void ge_double_scalarmult_base_vartime(ge_p2 *r, const unsigned char *a, const ge_p3 *A, const unsigned char *b) {
@@ -1177,8 +1400,8 @@ void ge_double_scalarmult_base_vartime(ge_p2 *r, const unsigned char *a, const g
   ge_p3 u;
   int i;
 
-  slide(aslide, a);
-  slide(bslide, b);
+  slide(aslide, a, 15);
+  slide(bslide, b, 63);
   ge_dsm_precomp(Ai, A);
 
   ge_p2_0(r);
@@ -1218,6 +1441,11 @@ int ge_frombytes_vartime(ge_p3 *h, const unsigned char *s) {
   fe vxx;
   fe check;
 
+#if defined(CRYPTO_OPS_FE64)
+  if (fe_frombytes_vartime(h->Y, s) != 0) {
+    return -1;
+  }
+#else
   /* From fe_frombytes.c */
 
   int64_t h0 = load_4(s);
@@ -1272,6 +1500,7 @@ int ge_frombytes_vartime(ge_p3 *h, const unsigned char *s) {
   h->Y[9] = h9;
 
   /* End fe_frombytes.c */
+#endif
 
   fe_1(h->Z);
   fe_sq(u, h->Y);
@@ -1594,6 +1823,40 @@ void ge_tobytes(unsigned char *s, const ge_p2 *h) {
   s[31] ^= fe_isnegative(x) << 7;
 }
 
+/* ge_tobytes of count points sharing a single inversion (Montgomery's trick), s receives 32 * count bytes.
+   scratch holds count field elements. Every Z must be nonzero, which holds for points on the curve. */
+
+void ge_tobytes_batch(unsigned char *s, const ge_p2 *h, fe *scratch, size_t count) {
+  fe recip;
+  fe x;
+  fe y;
+  size_t i;
+
+  if (count == 0) {
+    return;
+  }
+
+  fe_copy(scratch[0], h[0].Z);
+  for (i = 1; i < count; ++i) {
+    fe_mul(scratch[i], scratch[i - 1], h[i].Z);
+  }
+
+  fe_invert(recip, scratch[count - 1]);
+  for (i = count - 1; i > 0; --i) {
+    /* recip is 1 / (Z_0 * ... * Z_i) here */
+    fe_mul(scratch[i], recip, scratch[i - 1]);
+    fe_mul(recip, recip, h[i].Z);
+  }
+  fe_copy(scratch[0], recip);
+
+  for (i = 0; i < count; ++i) {
+    fe_mul(x, h[i].X, scratch[i]);
+    fe_mul(y, h[i].Y, scratch[i]);
+    fe_tobytes(s + 32 * i, y);
+    s[32 * i + 31] ^= fe_isnegative(x) << 7;
+  }
+}
+
 /* From sc_reduce.c */
 
 /*
@@ -1984,8 +2247,8 @@ void ge_double_scalarmult_precomp_vartime(ge_p2 *r, const unsigned char *a, cons
   ge_p3 u;
   int i;
 
-  slide(aslide, a);
-  slide(bslide, b);
+  slide(aslide, a, 15);
+  slide(bslide, b, 15);
   ge_dsm_precomp(Ai, A);
 
   ge_p2_0(r);
@@ -2030,6 +2293,9 @@ void ge_fromfe_frombytes_vartime(ge_p2 *r, const unsigned char *s) {
   fe u, v, w, x, y, z;
   unsigned char sign;
 
+#if defined(CRYPTO_OPS_FE64)
+  fe_frombytes_full(u, s);
+#else
   /* From fe_frombytes.c */
 
   int64_t h0 = load_4(s);
@@ -2077,6 +2343,7 @@ void ge_fromfe_frombytes_vartime(ge_p2 *r, const unsigned char *s) {
   u[9] = h9;
 
   /* End fe_frombytes.c */
+#endif
 
   fe_sq2(v, u); /* 2 * u^2 */
   fe_1(w);
@@ -7,7 +7,16 @@
 
 /* From fe.h */
 
+/* Where the compiler has 128-bit integers, field elements are five 51-bit limbs multiplied with 64x64->128 bit
+ * products. Otherwise, or when CRYPTO_OPS_FE32 is defined, the ref10 representation of ten 25.5-bit limbs is used.
+ * Both have the same size, only code that looks at the limbs depends on the choice.
+ */
+#if defined(__SIZEOF_INT128__) && !defined(CRYPTO_OPS_FE32)
+#define CRYPTO_OPS_FE64
+typedef uint64_t fe[5];
+#else
 typedef int32_t fe[10];
+#endif
 
 /* From ge.h */
 
@@ -51,7 +60,7 @@ void ge_add(ge_p1p1 *, const ge_p3 *, const ge_cached *);
 /* From ge_double_scalarmult.c, modified */
 
 typedef ge_cached ge_dsmp[8];
-extern const ge_precomp ge_Bi[8];
+extern const ge_precomp ge_Bi[32]; /* B, 3B, 5B, ..., 63B */
 void ge_dsm_precomp(ge_dsmp r, const ge_p3 *s);
 void ge_double_scalarmult_base_vartime(ge_p2 *, const unsigned char *, const ge_p3 *, const unsigned char *);
 
@@ -98,6 +107,7 @@ void ge_sub(ge_p1p1 *, const ge_p3 *, const ge_cached *);
 /* From ge_tobytes.c */
 
 void ge_tobytes(unsigned char *, const ge_p2 *);
+void ge_tobytes_batch(unsigned char *, const ge_p2 *, fe *, size_t);
 
 /* From sc_reduce.c */
 
@@ -11,6 +11,7 @@
 #include <cstring>
 #include <memory>
 #include <mutex>
+#include <vector>
 
 #include "common/varint.h"
 #include "warnings.h"
@@ -158,6 +159,62 @@ namespace crypto {
     return true;
   }
 
+  //a valid placeholder for entries that failed, so the batched inversion never sees a zero
+  static void set_identity(ge_p2 &point) {
+    ec_scalar zero;
+    ge_p3 identity;
+    sc_0(&zero);
+    ge_scalarmult_base(&identity, &zero);
+    ge_p3_to_p2(&point, &identity);
+  }
+
+  void crypto_ops::generate_key_derivations(const public_key *keys, size_t count, const secret_key &sec,
+    key_derivation *derivations, bool *valid) {
+    std::vector<ge_p2> points(count);
+    std::unique_ptr<fe[]> scratch(new fe[count]);
+    assert(sc_check(&sec) == 0);
+    for (size_t i = 0; i < count; ++i) {
+      ge_p3 point;
+      ge_p2 point2;
+      ge_p1p1 point3;
+      valid[i] = ge_frombytes_vartime(&point, &keys[i]) == 0;
+      if (!valid[i]) {
+        set_identity(points[i]);
+        continue;
+      }
+      ge_scalarmult(&point2, &sec, &point);
+      ge_mul8(&point3, &point2);
+      ge_p1p1_to_p2(&points[i], &point3);
+    }
+    static_assert(sizeof(key_derivation) == 32, "ge_tobytes_batch writes 32 bytes per point");
+    ge_tobytes_batch(reinterpret_cast<unsigned char *>(derivations), points.data(), scratch.get(), count);
+  }
+
+  void crypto_ops::underive_public_keys(const key_derivation *derivations, const size_t *output_indexes,
+    const public_key *derived_keys, size_t count, public_key *bases, bool *valid) {
+    std::vector<ge_p2> points(count);
+    std::unique_ptr<fe[]> scratch(new fe[count]);
+    for (size_t i = 0; i < count; ++i) {
+      ec_scalar scalar;
+      ge_p3 point1;
+      ge_p3 point2;
+      ge_cached point3;
+      ge_p1p1 point4;
+      valid[i] = ge_frombytes_vartime(&point1, &derived_keys[i]) == 0;
+      if (!valid[i]) {
+        set_identity(points[i]);
+        continue;
+      }
+      derivation_to_scalar(derivations[i], output_indexes[i], scalar);
+      ge_scalarmult_base(&point2, &scalar);
+      ge_p3_to_cached(&point3, &point2);
+      ge_sub(&point4, &point1, &point3);
+      ge_p1p1_to_p2(&points[i], &point4);
+    }
+    static_assert(sizeof(public_key) == 32, "ge_tobytes_batch writes 32 bytes per point");
+    ge_tobytes_batch(reinterpret_cast<unsigned char *>(bases), points.data(), scratch.get(), count);
+  }
+
   struct s_comm {
     hash h;
     ec_point key;
@@ -307,16 +364,39 @@ POP_WARNINGS
   bool crypto_ops::check_ring_signature(const hash &prefix_hash, const key_image &image,
     const public_key *const *pubs, size_t pubs_count,
     const signature *sig) {
+    std::vector<prepared_public_key> prepared(pubs_count);
+    std::vector<const prepared_public_key *> prepared_ptrs(pubs_count);
+    for (size_t i = 0; i < pubs_count; i++) {
+      if (!prepare_public_key(*pubs[i], prepared[i])) {
+        abort();
+      }
+      prepared_ptrs[i] = &prepared[i];
+    }
+    return check_ring_signature(prefix_hash, image, prepared_ptrs.data(), pubs_count, sig);
+  }
+
+  bool crypto_ops::prepare_public_key(const public_key &pub, prepared_public_key &prepared) {
+    static_assert(sizeof(prepared_public_key) == 2 * sizeof(ge_p3), "Invalid structure size");
+    ge_p3 *const points = reinterpret_cast<ge_p3 *>(prepared.data);
+    if (ge_frombytes_vartime(&points[0], &pub) != 0) {
+      return false;
+    }
+    hash_to_ec(pub, points[1]);
+    return true;
+  }
+
+  bool crypto_ops::check_ring_signature(const hash &prefix_hash, const key_image &image,
+    const prepared_public_key *const *pubs, size_t pubs_count,
+    const signature *sig) {
     size_t i;
     ge_p3 image_unp;
     ge_dsmp image_pre;
     ec_scalar sum, h;
     rs_comm *const buf = reinterpret_cast<rs_comm *>(alloca(rs_comm_size(pubs_count)));
-#if !defined(NDEBUG)
-    for (i = 0; i < pubs_count; i++) {
-      assert(check_key(*pubs[i]));
-    }
-#endif
+    //a and b of all members are converted to bytes at the end, sharing one field inversion
+    ge_p2 *const points = reinterpret_cast<ge_p2 *>(alloca(2 * pubs_count * sizeof(ge_p2)));
+    fe *const scratch = reinterpret_cast<fe *>(alloca(2 * pubs_count * sizeof(fe)));
+    static_assert(sizeof(rs_comm().ab[0]) == 2 * sizeof(ec_point), "ab must be a contiguous array of points");
     if (ge_frombytes_vartime(&image_unp, &image) != 0) {
       return false;
     }
@@ -324,21 +404,16 @@ POP_WARNINGS
     sc_0(&sum);
     buf->h = prefix_hash;
     for (i = 0; i < pubs_count; i++) {
-      ge_p2 tmp2;
-      ge_p3 tmp3;
+      //the decompressed key and its hash_to_ec point
+      const ge_p3 *const member = reinterpret_cast<const ge_p3 *>(pubs[i]->data);
       if (sc_check(&sig[i].c) != 0 || sc_check(&sig[i].r) != 0) {
         return false;
       }
-      if (ge_frombytes_vartime(&tmp3, &*pubs[i]) != 0) {
-        abort();
-      }
-      ge_double_scalarmult_base_vartime(&tmp2, &sig[i].c, &tmp3, &sig[i].r);
-      ge_tobytes(&buf->ab[i].a, &tmp2);
-      hash_to_ec(*pubs[i], tmp3);
-      ge_double_scalarmult_precomp_vartime(&tmp2, &sig[i].r, &tmp3, &sig[i].c, image_pre);
-      ge_tobytes(&buf->ab[i].b, &tmp2);
+      ge_double_scalarmult_base_vartime(&points[2 * i], &sig[i].c, &member[0], &sig[i].r);
+      ge_double_scalarmult_precomp_vartime(&points[2 * i + 1], &sig[i].r, &member[1], &sig[i].c, image_pre);
       sc_add(&sum, &sum, &sig[i].c);
     }
+    ge_tobytes_batch(&buf->ab[0].a, points, scratch, 2 * pubs_count);
     hash_to_scalar(buf, rs_comm_size(pubs_count), h);
     sc_sub(&h, &h, &sum);
     return sc_isnonzero(&h) == 0;
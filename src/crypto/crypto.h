@@ -6,6 +6,7 @@
 #pragma once
 
 #include <cstddef>
+#include <cstdint>
 #include <limits>
 #include <mutex>
 #include <vector>
@@ -60,6 +61,14 @@ namespace crypto {
     sizeof(key_derivation) == 32 && sizeof(key_image) == 32 &&
     sizeof(signature) == 64, "Invalid structure size");
 
+  /* Public key of a ring member decompressed and hashed to a point, the costly part of checking it.
+   * Holds two ge_p3, so it can be computed once and cached for keys used in many rings.
+   */
+  POD_CLASS prepared_public_key {
+    std::uint64_t data[40];
+    friend class crypto_ops;
+  };
+
   class crypto_ops {
     crypto_ops();
     crypto_ops(const crypto_ops &);
@@ -80,6 +89,12 @@ namespace crypto {
     friend void derive_secret_key(const key_derivation &, std::size_t, const secret_key &, secret_key &);
     static bool underive_public_key(const key_derivation &, std::size_t, const public_key &, public_key &);
     friend bool underive_public_key(const key_derivation &, std::size_t, const public_key &, public_key &);
+    static void generate_key_derivations(const public_key *, std::size_t, const secret_key &, key_derivation *, bool *);
+    friend void generate_key_derivations(const public_key *, std::size_t, const secret_key &, key_derivation *, bool *);
+    static void underive_public_keys(const key_derivation *, const std::size_t *, const public_key *, std::size_t,
+      public_key *, bool *);
+    friend void underive_public_keys(const key_derivation *, const std::size_t *, const public_key *, std::size_t,
+      public_key *, bool *);
     static void generate_signature(const hash &, const public_key &, const secret_key &, signature &);
     friend void generate_signature(const hash &, const public_key &, const secret_key &, signature &);
     static bool check_signature(const hash &, const public_key &, const signature &);
@@ -94,6 +109,12 @@ namespace crypto {
       const public_key *const *, std::size_t, const signature *);
     friend bool check_ring_signature(const hash &, const key_image &,
       const public_key *const *, std::size_t, const signature *);
+    static bool prepare_public_key(const public_key &, prepared_public_key &);
+    friend bool prepare_public_key(const public_key &, prepared_public_key &);
+    static bool check_ring_signature(const hash &, const key_image &,
+      const prepared_public_key *const *, std::size_t, const signature *);
+    friend bool check_ring_signature(const hash &, const key_image &,
+      const prepared_public_key *const *, std::size_t, const signature *);
   };
 
   /* Generate a value filled with random bytes.
@@ -178,6 +199,19 @@ namespace crypto {
     return crypto_ops::underive_public_key(derivation, output_index, derived_key, base);
   }
 
+  /* Batch variants of generate_key_derivation and underive_public_key for scanning many outputs at once.
+   * Element i of the outputs is computed from element i of each input; valid[i] is set to false where the
+   * single key function would fail. The conversions back to bytes share a single field inversion.
+   */
+  inline void generate_key_derivations(const public_key *keys, std::size_t count, const secret_key &sec,
+    key_derivation *derivations, bool *valid) {
+    crypto_ops::generate_key_derivations(keys, count, sec, derivations, valid);
+  }
+  inline void underive_public_keys(const key_derivation *derivations, const std::size_t *output_indexes,
+    const public_key *derived_keys, std::size_t count, public_key *bases, bool *valid) {
+    crypto_ops::underive_public_keys(derivations, output_indexes, derived_keys, count, bases, valid);
+  }
+
   /* Generation and checking of a standard signature.
    */
   inline void generate_signature(const hash &prefix_hash, const public_key &pub, const secret_key &sec, signature &sig) {
@@ -208,6 +242,17 @@ namespace crypto {
     return crypto_ops::check_ring_signature(prefix_hash, image, pubs, pubs_count, sig);
   }
 
+  /* Prepare a public key for check_ring_signature, fails if the key is not a valid point.
+   */
+  inline bool prepare_public_key(const public_key &pub, prepared_public_key &prepared) {
+    return crypto_ops::prepare_public_key(pub, prepared);
+  }
+  inline bool check_ring_signature(const hash &prefix_hash, const key_image &image,
+    const prepared_public_key *const *pubs, std::size_t pubs_count,
+    const signature *sig) {
+    return crypto_ops::check_ring_signature(prefix_hash, image, pubs, pubs_count, sig);
+  }
+
   /* Variants with vector<const public_key *> parameters.
    */
   inline void generate_ring_signature(const hash &prefix_hash, const key_image &image,
@@ -221,6 +266,11 @@ namespace crypto {
     const signature *sig) {
     return check_ring_signature(prefix_hash, image, pubs.data(), pubs.size(), sig);
   }
+  inline bool check_ring_signature(const hash &prefix_hash, const key_image &image,
+    const std::vector<const prepared_public_key *> &pubs,
+    const signature *sig) {
+    return check_ring_signature(prefix_hash, image, pubs.data(), pubs.size(), sig);
+  }
 }
 
 CRYPTO_MAKE_HASHABLE(public_key)
@@ -52,12 +52,20 @@ void hash_process(union hash_state *state, const uint8_t *buf, size_t count);
 enum {
   HASH_SIZE = 32,
   HASH_DATA_AREA = 136,
-  SLOW_HASH_CONTEXT_SIZE = 2097552
+  SLOW_HASH_CONTEXT_SIZE = 2097552,
+  CN_SLOW_HASH_MAX_WAYS = 4
 };
 
 void cn_fast_hash(const void *data, size_t length, char *hash);
+/* Hashes `count` independent inputs, the results are written one after another and must not overlap the inputs */
+void cn_fast_hash_n(const void *const *data, const size_t *length, size_t count, char *hashes);
 
 void cn_slow_hash_f(void *, const void *, size_t, void *);
+/* Hashes `ways` inputs of the same length at once; the context holds `ways` consecutive slow hash contexts
+ * and the results are written one after another */
+void cn_slow_hash_ways_f(void *context, size_t ways, const void *const *data, size_t length, void *hash);
+/* Number of ways worth interleaving when `threads` threads hash at the same time, from CPU features and L3 size */
+size_t cn_slow_hash_preferred_ways(size_t threads);
 
 void hash_extra_blake(const void *data, size_t length, char *hash);
 void hash_extra_groestl(const void *data, size_t length, char *hash);
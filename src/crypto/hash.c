@@ -23,3 +23,7 @@ void cn_fast_hash(const void *data, size_t length, char *hash) {
   hash_process(&state, data, length);
   memcpy(hash, &state, HASH_SIZE);
 }
+
+void cn_fast_hash_n(const void *const *data, const size_t *length, size_t count, char *hashes) {
+  keccak_n((const uint8_t *const *) data, length, count, (uint8_t *) hashes, HASH_SIZE);
+}
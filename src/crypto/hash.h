@@ -38,26 +38,52 @@ namespace crypto {
     return h;
   }
 
+  inline void cn_fast_hash_n(const void *const *data, const std::size_t *length, std::size_t count, hash *hashes) {
+    cn_fast_hash_n(data, length, count, reinterpret_cast<char *>(hashes));
+  }
+
   class cn_context {
   public:
 
-    cn_context();
+    //holds one scratchpad per way, 1..CN_SLOW_HASH_MAX_WAYS; huge_pages = false keeps them on regular pages
+    explicit cn_context(std::size_t ways = 1, bool huge_pages = true);
     ~cn_context();
 #if !defined(_MSC_VER) || _MSC_VER >= 1800
     cn_context(const cn_context &) = delete;
     void operator=(const cn_context &) = delete;
 #endif
 
+    std::size_t get_ways() const { return ways; }
+
+    enum memory_backing {
+      MEMORY_PAGES,
+      MEMORY_TRANSPARENT_HUGE_PAGES,
+      MEMORY_HUGE_PAGES
+    };
+
+    //tried in order: explicit huge pages, transparent huge pages, regular pages; reports what the kernel really gave
+    memory_backing get_memory_backing() const;
+    const char *get_memory_backing_name() const;
+
   private:
 
     void *data;
+    std::size_t ways;
+    std::size_t size;
+    memory_backing backing;
     friend inline void cn_slow_hash(cn_context &, const void *, std::size_t, hash &);
+    friend inline void cn_slow_hash_ways(cn_context &, const void *const *, std::size_t, hash *);
   };
 
   inline void cn_slow_hash(cn_context &context, const void *data, std::size_t length, hash &hash) {
     (*cn_slow_hash_f)(context.data, data, length, reinterpret_cast<void *>(&hash));
   }
 
+  //hashes context.get_ways() inputs of the same length in one pass
+  inline void cn_slow_hash_ways(cn_context &context, const void *const *data, std::size_t length, hash *hashes) {
+    cn_slow_hash_ways_f(context.data, context.ways, data, length, reinterpret_cast<void *>(hashes));
+  }
+
   inline void tree_hash(const hash *hashes, std::size_t count, hash &root_hash) {
     tree_hash(reinterpret_cast<const char (*)[HASH_SIZE]>(hashes), count, reinterpret_cast<char *>(&root_hash));
   }
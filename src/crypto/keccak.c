@@ -5,6 +5,10 @@
 #include "hash-ops.h"
 #include "keccak.h"
 
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
 const uint64_t keccakf_rndc[24] = 
 {
     0x0000000000000001, 0x0000000000008082, 0x800000000000808a,
@@ -110,3 +114,152 @@ void keccak1600(const uint8_t *in, int inlen, uint8_t *md)
 {
     keccak(in, inlen, md, sizeof(state_t));
 }
+
+#if defined(__AVX2__)
+
+#define ROTL64X4(x, y) _mm256_or_si256(_mm256_slli_epi64((x), (y)), _mm256_srli_epi64((x), 64 - (y)))
+
+// keccakf on four interleaved states, one per 64-bit lane of each word
+
+static void keccakf_x4(__m256i st[25], int rounds)
+{
+    int i, j, round;
+    __m256i t, bc[5];
+
+    for (round = 0; round < rounds; round++) {
+
+        // Theta
+        for (i = 0; i < 5; i++)
+            bc[i] = _mm256_xor_si256(_mm256_xor_si256(_mm256_xor_si256(st[i], st[i + 5]),
+                _mm256_xor_si256(st[i + 10], st[i + 15])), st[i + 20]);
+
+        for (i = 0; i < 5; i++) {
+            t = _mm256_xor_si256(bc[(i + 4) % 5], ROTL64X4(bc[(i + 1) % 5], 1));
+            for (j = 0; j < 25; j += 5)
+                st[j + i] = _mm256_xor_si256(st[j + i], t);
+        }
+
+        // Rho Pi
+        t = st[1];
+        for (i = 0; i < 24; i++) {
+            j = keccakf_piln[i];
+            bc[0] = st[j];
+            st[j] = ROTL64X4(t, keccakf_rotc[i]);
+            t = bc[0];
+        }
+
+        //  Chi
+        for (j = 0; j < 25; j += 5) {
+            for (i = 0; i < 5; i++)
+                bc[i] = st[j + i];
+            for (i = 0; i < 5; i++)
+                st[j + i] = _mm256_xor_si256(st[j + i], _mm256_andnot_si256(bc[(i + 1) % 5], bc[(i + 2) % 5]));
+        }
+
+        //  Iota
+        st[0] = _mm256_xor_si256(st[0], _mm256_set1_epi64x((long long) keccakf_rndc[round]));
+    }
+}
+
+typedef union {
+    __m256i v[25];
+    uint64_t w[25][4];
+} state_x4_t;
+
+// each lane absorbs its own input and takes the next one as soon as its digest is out,
+// so inputs of different lengths keep all four lanes busy
+
+static void keccak_x4(const uint8_t *const *in, const size_t *inlen, size_t count, uint8_t *md, int mdlen)
+{
+    state_x4_t st;
+    uint8_t temp[144];
+    const uint8_t *lane_in[4];
+    size_t lane_left[4], lane_item[4];
+    int lane_last[4];
+    size_t next = 0, active = 0;
+    uint64_t w;
+    int i, l, rsiz, rsizw;
+
+    rsiz = 200 - 2 * mdlen;
+    rsizw = rsiz / 8;
+
+    memset(&st, 0, sizeof(st));
+    for (l = 0; l < 4; l++) {
+        lane_item[l] = count;
+        lane_last[l] = 0;
+        if (next < count) {
+            lane_item[l] = next;
+            lane_in[l] = in[next];
+            lane_left[l] = inlen[next];
+            next++;
+            active++;
+        }
+    }
+
+    while (active > 0) {
+        for (l = 0; l < 4; l++) {
+            if (lane_item[l] == count)
+                continue;
+
+            if (lane_left[l] >= (size_t) rsiz) {
+                for (i = 0; i < rsizw; i++) {
+                    memcpy(&w, lane_in[l] + 8 * i, 8);
+                    st.w[i][l] ^= w;
+                }
+                lane_in[l] += rsiz;
+                lane_left[l] -= rsiz;
+                lane_last[l] = 0;
+            } else {
+                // last block and padding
+                memcpy(temp, lane_in[l], lane_left[l]);
+                temp[lane_left[l]] = 1;
+                memset(temp + lane_left[l] + 1, 0, rsiz - lane_left[l] - 1);
+                temp[rsiz - 1] |= 0x80;
+                for (i = 0; i < rsizw; i++) {
+                    memcpy(&w, temp + 8 * i, 8);
+                    st.w[i][l] ^= w;
+                }
+                lane_last[l] = 1;
+            }
+        }
+
+        keccakf_x4(st.v, KECCAK_ROUNDS);
+
+        for (l = 0; l < 4; l++) {
+            if (lane_item[l] == count || !lane_last[l])
+                continue;
+
+            for (i = 0; i < mdlen; i += 8)
+                memcpy(md + lane_item[l] * mdlen + i, &st.w[i / 8][l], mdlen - i < 8 ? mdlen - i : 8);
+            for (i = 0; i < 25; i++)
+                st.w[i][l] = 0;
+
+            if (next < count) {
+                lane_item[l] = next;
+                lane_in[l] = in[next];
+                lane_left[l] = inlen[next];
+                next++;
+            } else {
+                lane_item[l] = count;
+                active--;
+            }
+        }
+    }
+}
+
+#endif
+
+void keccak_n(const uint8_t *const *in, const size_t *inlen, size_t count, uint8_t *md, int mdlen)
+{
+    size_t i;
+
+#if defined(__AVX2__)
+    if (count > 1 && mdlen < 100) {
+        keccak_x4(in, inlen, count, md, mdlen);
+        return;
+    }
+#endif
+
+    for (i = 0; i < count; i++)
+        keccak(in[i], (int) inlen[i], md + i * mdlen, mdlen);
+}
@@ -23,4 +23,8 @@ void keccakf(uint64_t st[25], int norounds);
 
 void keccak1600(const uint8_t *in, int inlen, uint8_t *md);
 
+// compute count keccak hashes (md) of mdlen bytes each, stored one after another;
+// four inputs go through the permutation at once when AVX2 is available
+void keccak_n(const uint8_t *const *in, const size_t *inlen, size_t count, uint8_t *md, int mdlen);
+
 #endif
@@ -14,6 +14,7 @@
 #include <intrin.h>
 #else
 #include <cpuid.h>
+#include <unistd.h>
 #endif
 
 #include "aesb.h"
@@ -167,6 +168,65 @@ static void (*const extra_hashes[4])(const void *, size_t, char *) =
 #define AESNI
 #include "slow-hash.inl"
 
+static int has_aesni;
+
+void cn_slow_hash_ways_f(void *context, size_t ways, const void *const *data, size_t length, void *hash) {
+  size_t w;
+  if (has_aesni && ways == 2) {
+    cn_slow_hash_aesni_2way(context, data, length, hash);
+  } else if (has_aesni && ways == 4) {
+    cn_slow_hash_aesni_4way(context, data, length, hash);
+  } else {
+    for (w = 0; w < ways; w++) {
+      (*cn_slow_hash_fp)((struct cn_ctx *) context + w, data[w], length, (char *) hash + w * HASH_SIZE);
+    }
+  }
+}
+
+static size_t l3_cache_size(void) {
+#if defined(_SC_LEVEL3_CACHE_SIZE)
+  long size = sysconf(_SC_LEVEL3_CACHE_SIZE);
+  return size > 0 ? (size_t) size : 0;
+#else
+  /* deterministic cache parameters leaf: walk the caches until the unified level 3 one */
+  int i;
+  for (i = 0; i < 16; i++) {
+    unsigned int a, b, c, d;
+#if defined(_MSC_VER)
+    int cpuinfo[4];
+    __cpuidex(cpuinfo, 4, i);
+    a = cpuinfo[0];
+    b = cpuinfo[1];
+    c = cpuinfo[2];
+    d = cpuinfo[3];
+#else
+    __cpuid_count(4, i, a, b, c, d);
+#endif
+    if ((a & 0x1f) == 0) {
+      break;
+    }
+    if (((a >> 5) & 0x7) == 3) {
+      return (size_t) (((b >> 22) & 0x3ff) + 1) * (((b >> 12) & 0x3ff) + 1) * ((b & 0xfff) + 1) * ((size_t) c + 1);
+    }
+  }
+  return 0;
+#endif
+}
+
+size_t cn_slow_hash_preferred_ways(size_t threads) {
+  size_t per_thread;
+  if (!has_aesni) {
+    return 1;
+  }
+
+  /* every way needs its own scratchpad to stay in cache */
+  per_thread = l3_cache_size() / (threads > 0 ? threads : 1);
+  if (per_thread >= 4 * MEMORY) {
+    return 4;
+  }
+  return per_thread >= 2 * MEMORY ? 2 : 1;
+}
+
 INITIALIZER(detect_aes) {
   int ecx;
 #if defined(_MSC_VER)
@@ -177,5 +237,6 @@ INITIALIZER(detect_aes) {
   int a, b, d;
   __cpuid(1, a, b, ecx, d);
 #endif
-  cn_slow_hash_fp = (ecx & (1 << 25)) ? &cn_slow_hash_aesni : &cn_slow_hash_noaesni;
+  has_aesni = (ecx & (1 << 25)) != 0;
+  cn_slow_hash_fp = has_aesni ? &cn_slow_hash_aesni : &cn_slow_hash_noaesni;
 }
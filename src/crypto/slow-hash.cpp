@@ -3,7 +3,10 @@
 // Distributed under the MIT/X11 software license, see the accompanying
 // file COPYING or http://www.opensource.org/licenses/mit-license.php.
 
+#include <cstdint>
+#include <cstdio>
 #include <new>
+#include <stdexcept>
 
 #include "hash.h"
 
@@ -17,14 +20,63 @@ using std::bad_alloc;
 
 namespace crypto {
 
-  enum {
-    MAP_SIZE = SLOW_HASH_CONTEXT_SIZE + ((-SLOW_HASH_CONTEXT_SIZE) & 0xfff)
-  };
+  namespace {
+    const std::size_t PAGE_SIZE_4K = 0x1000;
+    const std::size_t HUGE_PAGE_SIZE = 1 << 21;
+
+    std::size_t round_up(std::size_t size, std::size_t alignment) {
+      return size + ((0 - size) & (alignment - 1));
+    }
+
+    std::size_t map_size(std::size_t ways) {
+      return round_up(ways * SLOW_HASH_CONTEXT_SIZE, PAGE_SIZE_4K);
+    }
+
+    std::size_t check_ways(std::size_t ways) {
+      if (ways == 0 || ways > CN_SLOW_HASH_MAX_WAYS) {
+        throw std::invalid_argument("cn_context: unsupported number of ways");
+      }
+      return ways;
+    }
+
+#if defined(MADV_HUGEPAGE) || defined(MADV_NOHUGEPAGE)
+    //populate now, mlock alone does not when RLIMIT_MEMLOCK is low
+    void populate(void *data, std::size_t size) {
+      for (std::size_t offset = 0; offset < size; offset += PAGE_SIZE_4K) {
+        static_cast<volatile char *>(data)[offset] = 0;
+      }
+      mlock(data, size);
+    }
+#endif
+  }
+
+  const char *cn_context::get_memory_backing_name() const {
+    switch (get_memory_backing()) {
+    case MEMORY_HUGE_PAGES:
+      return "huge pages";
+    case MEMORY_TRANSPARENT_HUGE_PAGES:
+      return "transparent huge pages";
+    default:
+      return "regular pages";
+    }
+  }
 
 #if defined(WIN32)
 
-  cn_context::cn_context() {
-    data = VirtualAlloc(nullptr, MAP_SIZE, MEM_COMMIT, PAGE_READWRITE);
+  cn_context::cn_context(std::size_t ways, bool huge_pages) : ways(check_ways(ways)), backing(MEMORY_PAGES) {
+    //large pages need the "Lock pages in memory" privilege, without it the allocation fails
+    std::size_t large_page = huge_pages ? GetLargePageMinimum() : 0;
+    if (large_page != 0) {
+      size = round_up(map_size(ways), large_page);
+      data = VirtualAlloc(nullptr, size, MEM_COMMIT | MEM_RESERVE | MEM_LARGE_PAGES, PAGE_READWRITE);
+      if (data != nullptr) {
+        backing = MEMORY_HUGE_PAGES;
+        return;
+      }
+    }
+
+    size = map_size(ways);
+    data = VirtualAlloc(nullptr, size, MEM_COMMIT, PAGE_READWRITE);
     if (data == nullptr) {
       throw bad_alloc();
     }
@@ -36,26 +88,108 @@ namespace crypto {
     }
   }
 
+  cn_context::memory_backing cn_context::get_memory_backing() const {
+    return backing;
+  }
+
 #else
 
-  cn_context::cn_context() {
+  cn_context::cn_context(std::size_t ways, bool huge_pages) : ways(check_ways(ways)), backing(MEMORY_PAGES) {
+    //pages are populated by the constructing thread, so a thread pinned to a core gets memory of its own NUMA node
+#if defined(MADV_NOHUGEPAGE)
+    if (!huge_pages) {
+      //advised before the first touch, so transparent huge pages enabled system wide do not apply either
+      size = map_size(ways);
+      data = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+      if (data == MAP_FAILED) {
+        throw bad_alloc();
+      }
+      madvise(data, size, MADV_NOHUGEPAGE);
+      populate(data, size);
+      return;
+    }
+#endif
+
+#if defined(MAP_HUGETLB)
+    size = round_up(map_size(ways), HUGE_PAGE_SIZE);
+    data = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB | MAP_POPULATE, -1, 0);
+    if (data != MAP_FAILED) {
+      backing = MEMORY_HUGE_PAGES;
+      return;
+    }
+#endif
+
+#if defined(MADV_HUGEPAGE)
+    //transparent huge pages need a 2 MiB aligned range, map one huge page more and trim it
+    size = map_size(ways);
+    void *mapping = mmap(nullptr, size + HUGE_PAGE_SIZE, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (mapping != MAP_FAILED) {
+      std::uintptr_t start = reinterpret_cast<std::uintptr_t>(mapping);
+      std::uintptr_t aligned = round_up(start, HUGE_PAGE_SIZE);
+      if (aligned != start) {
+        munmap(mapping, aligned - start);
+      }
+      if (start + HUGE_PAGE_SIZE != aligned) {
+        munmap(reinterpret_cast<void *>(aligned + size), start + HUGE_PAGE_SIZE - aligned);
+      }
+
+      data = reinterpret_cast<void *>(aligned);
+      if (madvise(data, size, MADV_HUGEPAGE) == 0) {
+        backing = MEMORY_TRANSPARENT_HUGE_PAGES;
+      }
+
+      populate(data, size);
+      return;
+    }
+#endif
+
+    size = map_size(ways);
 #if !defined(__APPLE__)
-    data = mmap(nullptr, MAP_SIZE, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_POPULATE, -1, 0);
+    data = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_POPULATE, -1, 0);
 #else
-    data = mmap(nullptr, MAP_SIZE, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANON, -1, 0);
+    data = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANON, -1, 0);
 #endif
     if (data == MAP_FAILED) {
       throw bad_alloc();
     }
-    mlock(data, MAP_SIZE);
+    mlock(data, size);
   }
 
   cn_context::~cn_context() {
-    if (munmap(data, MAP_SIZE) != 0) {
+    if (munmap(data, size) != 0) {
       throw bad_alloc();
     }
   }
 
+  cn_context::memory_backing cn_context::get_memory_backing() const {
+    if (backing != MEMORY_TRANSPARENT_HUGE_PAGES) {
+      return backing;
+    }
+
+    //madvise is only a hint, ask the kernel whether the range really got huge pages
+    std::FILE *smaps = std::fopen("/proc/self/smaps", "r");
+    if (smaps == nullptr) {
+      return MEMORY_PAGES;
+    }
+
+    std::uintptr_t address = reinterpret_cast<std::uintptr_t>(data);
+    bool in_range = false;
+    unsigned long huge_kb = 0;
+    char line[512];
+    while (std::fgets(line, sizeof(line), smaps) != nullptr) {
+      unsigned long long start;
+      unsigned long long end;
+      if (std::sscanf(line, "%llx-%llx ", &start, &end) == 2) {
+        in_range = start <= address && address < end;
+      } else if (in_range && std::sscanf(line, "AnonHugePages: %lu kB", &huge_kb) == 1) {
+        break;
+      }
+    }
+
+    std::fclose(smaps);
+    return huge_kb != 0 ? MEMORY_TRANSPARENT_HUGE_PAGES : MEMORY_PAGES;
+  }
+
 #endif
 
 }
@@ -3,19 +3,18 @@
 // Distributed under the MIT/X11 software license, see the accompanying
 // file COPYING or http://www.opensource.org/licenses/mit-license.php.
 
-static void
 #if defined(AESNI)
-cn_slow_hash_aesni
+#define CN_VARIANT(name) name##_aesni
 #else
-cn_slow_hash_noaesni
+#define CN_VARIANT(name) name##_noaesni
 #endif
-(void *restrict context, const void *restrict data, size_t length, void *restrict hash)
+
+/* Keccak of the input, then fill the scratchpad and set up a and b for the main loop */
+static inline void CN_VARIANT(cn_explode)(struct cn_ctx *ctx, const void *data, size_t length)
 {
-#define ctx ((struct cn_ctx *) context)
   uint8_t ExpandedKey[256];
   size_t i, j;
-  __m128i *longoutput, *expkey, *xmminput, b_x;
-  ALIGNED_DECL(uint64_t a[2], 16);
+  __m128i *longoutput, *expkey, *xmminput;
   hash_process(&ctx->state.hs, (const uint8_t*) data, length);
 
   memcpy(ctx->text, ctx->state.init, INIT_SIZE_BYTE);
@@ -74,6 +73,83 @@ cn_slow_hash_noaesni
     ctx->a[i] = ((uint64_t *)ctx->state.k)[i] ^  ((uint64_t *)ctx->state.k)[i+4];
     ctx->b[i] = ((uint64_t *)ctx->state.k)[i+2] ^  ((uint64_t *)ctx->state.k)[i+6];
   }
+}
+
+/* Fold the scratchpad back into the Keccak state and pick the final hash */
+static inline void CN_VARIANT(cn_implode)(struct cn_ctx *ctx, void *hash)
+{
+  uint8_t ExpandedKey[256];
+  size_t i, j;
+  __m128i *longoutput, *expkey, *xmminput;
+
+  memcpy(ctx->text, ctx->state.init, INIT_SIZE_BYTE);
+#if defined(AESNI)
+  memcpy(ExpandedKey, &ctx->state.hs.b[32], AES_KEY_SIZE);
+  ExpandAESKey256(ExpandedKey);
+#else
+  oaes_key_import_data(ctx->aes_ctx, &ctx->state.hs.b[32], AES_KEY_SIZE);
+  memcpy(ExpandedKey, ctx->aes_ctx->key->exp_data, ctx->aes_ctx->key->exp_data_len);
+#endif
+
+  longoutput = (__m128i *) ctx->long_state;
+  expkey = (__m128i *) ExpandedKey;
+  xmminput = (__m128i *) ctx->text;
+
+  //for (i = 0; likely(i < MEMORY); i += INIT_SIZE_BYTE)
+  //    aesni_parallel_xor(&ctx->text, ExpandedKey, &ctx->long_state[i]);
+
+  for (i = 0; likely(i < MEMORY); i += INIT_SIZE_BYTE)
+  {
+    xmminput[0] = _mm_xor_si128(longoutput[(i >> 4)], xmminput[0]);
+    xmminput[1] = _mm_xor_si128(longoutput[(i >> 4) + 1], xmminput[1]);
+    xmminput[2] = _mm_xor_si128(longoutput[(i >> 4) + 2], xmminput[2]);
+    xmminput[3] = _mm_xor_si128(longoutput[(i >> 4) + 3], xmminput[3]);
+    xmminput[4] = _mm_xor_si128(longoutput[(i >> 4) + 4], xmminput[4]);
+    xmminput[5] = _mm_xor_si128(longoutput[(i >> 4) + 5], xmminput[5]);
+    xmminput[6] = _mm_xor_si128(longoutput[(i >> 4) + 6], xmminput[6]);
+    xmminput[7] = _mm_xor_si128(longoutput[(i >> 4) + 7], xmminput[7]);
+
+#if defined(AESNI)
+    for(j = 0; j < 10; j++)
+    {
+      xmminput[0] = _mm_aesenc_si128(xmminput[0], expkey[j]);
+      xmminput[1] = _mm_aesenc_si128(xmminput[1], expkey[j]);
+      xmminput[2] = _mm_aesenc_si128(xmminput[2], expkey[j]);
+      xmminput[3] = _mm_aesenc_si128(xmminput[3], expkey[j]);
+      xmminput[4] = _mm_aesenc_si128(xmminput[4], expkey[j]);
+      xmminput[5] = _mm_aesenc_si128(xmminput[5], expkey[j]);
+      xmminput[6] = _mm_aesenc_si128(xmminput[6], expkey[j]);
+      xmminput[7] = _mm_aesenc_si128(xmminput[7], expkey[j]);
+    }
+#else
+    aesb_pseudo_round((uint8_t *) &xmminput[0], (uint8_t *) &xmminput[0], (uint8_t *) expkey);
+    aesb_pseudo_round((uint8_t *) &xmminput[1], (uint8_t *) &xmminput[1], (uint8_t *) expkey);
+    aesb_pseudo_round((uint8_t *) &xmminput[2], (uint8_t *) &xmminput[2], (uint8_t *) expkey);
+    aesb_pseudo_round((uint8_t *) &xmminput[3], (uint8_t *) &xmminput[3], (uint8_t *) expkey);
+    aesb_pseudo_round((uint8_t *) &xmminput[4], (uint8_t *) &xmminput[4], (uint8_t *) expkey);
+    aesb_pseudo_round((uint8_t *) &xmminput[5], (uint8_t *) &xmminput[5], (uint8_t *) expkey);
+    aesb_pseudo_round((uint8_t *) &xmminput[6], (uint8_t *) &xmminput[6], (uint8_t *) expkey);
+    aesb_pseudo_round((uint8_t *) &xmminput[7], (uint8_t *) &xmminput[7], (uint8_t *) expkey);
+#endif
+
+  }
+
+#if !defined(AESNI)
+  oaes_free((OAES_CTX **) &ctx->aes_ctx);
+#endif
+
+  memcpy(ctx->state.init, ctx->text, INIT_SIZE_BYTE);
+  hash_permutation(&ctx->state.hs);
+  extra_hashes[ctx->state.hs.b[0] & 3](&ctx->state, 200, hash);
+}
+
+static void CN_VARIANT(cn_slow_hash)(void *restrict context, const void *restrict data, size_t length, void *restrict hash)
+{
+#define ctx ((struct cn_ctx *) context)
+  size_t i;
+  __m128i b_x;
+  ALIGNED_DECL(uint64_t a[2], 16);
+  CN_VARIANT(cn_explode)(ctx, data, length);
 
   b_x = _mm_load_si128((__m128i *)ctx->b);
   a[0] = ctx->a[0];
@@ -131,59 +207,94 @@ cn_slow_hash_noaesni
     //__builtin_prefetch(&ctx->long_state[a[0] & 0x1FFFF0], 0, 3);
   }
 
-  memcpy(ctx->text, ctx->state.init, INIT_SIZE_BYTE);
-#if defined(AESNI)
-  memcpy(ExpandedKey, &ctx->state.hs.b[32], AES_KEY_SIZE);
-  ExpandAESKey256(ExpandedKey);
-#else
-  oaes_key_import_data(ctx->aes_ctx, &ctx->state.hs.b[32], AES_KEY_SIZE);
-  memcpy(ExpandedKey, ctx->aes_ctx->key->exp_data, ctx->aes_ctx->key->exp_data_len);
-#endif
+  CN_VARIANT(cn_implode)(ctx, hash);
+#undef ctx
+}
 
-  //for (i = 0; likely(i < MEMORY); i += INIT_SIZE_BYTE)
-  //    aesni_parallel_xor(&ctx->text, ExpandedKey, &ctx->long_state[i]);
+#if defined(AESNI)
+/* The main loop is one long dependent chain of loads, AES rounds and multiplies. Running several
+ * hashes side by side, each on its own scratchpad, gives the core independent work to overlap.
+ * Callers pass a constant number of ways so the lane loop is unrolled. */
+static inline __attribute__((always_inline)) void cn_slow_hash_aesni_ways(void *context, size_t ways,
+  const void *const *data, size_t length, void *hash)
+{
+  struct cn_ctx *ctx[CN_SLOW_HASH_MAX_WAYS];
+  __m128i b_x[CN_SLOW_HASH_MAX_WAYS];
+  ALIGNED_DECL(uint64_t a[CN_SLOW_HASH_MAX_WAYS][2], 16);
+  size_t i, w;
 
-  for (i = 0; likely(i < MEMORY); i += INIT_SIZE_BYTE)
+  for (w = 0; w < ways; w++)
   {
-    xmminput[0] = _mm_xor_si128(longoutput[(i >> 4)], xmminput[0]);
-    xmminput[1] = _mm_xor_si128(longoutput[(i >> 4) + 1], xmminput[1]);
-    xmminput[2] = _mm_xor_si128(longoutput[(i >> 4) + 2], xmminput[2]);
-    xmminput[3] = _mm_xor_si128(longoutput[(i >> 4) + 3], xmminput[3]);
-    xmminput[4] = _mm_xor_si128(longoutput[(i >> 4) + 4], xmminput[4]);
-    xmminput[5] = _mm_xor_si128(longoutput[(i >> 4) + 5], xmminput[5]);
-    xmminput[6] = _mm_xor_si128(longoutput[(i >> 4) + 6], xmminput[6]);
-    xmminput[7] = _mm_xor_si128(longoutput[(i >> 4) + 7], xmminput[7]);
+    ctx[w] = (struct cn_ctx *) context + w;
+    cn_explode_aesni(ctx[w], data[w], length);
+    b_x[w] = _mm_load_si128((__m128i *)ctx[w]->b);
+    a[w][0] = ctx[w]->a[0];
+    a[w][1] = ctx[w]->a[1];
+  }
 
-#if defined(AESNI)
-    for(j = 0; j < 10; j++)
+  for(i = 0; likely(i < 0x80000); i++)
+  {
+    for (w = 0; w < ways; w++)
     {
-      xmminput[0] = _mm_aesenc_si128(xmminput[0], expkey[j]);
-      xmminput[1] = _mm_aesenc_si128(xmminput[1], expkey[j]);
-      xmminput[2] = _mm_aesenc_si128(xmminput[2], expkey[j]);
-      xmminput[3] = _mm_aesenc_si128(xmminput[3], expkey[j]);
-      xmminput[4] = _mm_aesenc_si128(xmminput[4], expkey[j]);
-      xmminput[5] = _mm_aesenc_si128(xmminput[5], expkey[j]);
-      xmminput[6] = _mm_aesenc_si128(xmminput[6], expkey[j]);
-      xmminput[7] = _mm_aesenc_si128(xmminput[7], expkey[j]);
-    }
+      uint8_t *long_state = ctx[w]->long_state;
+      __m128i c_x = _mm_load_si128((__m128i *)&long_state[a[w][0] & 0x1FFFF0]);
+      __m128i a_x = _mm_load_si128((__m128i *)a[w]);
+      ALIGNED_DECL(uint64_t c[2], 16);
+      ALIGNED_DECL(uint64_t b[2], 16);
+      uint64_t *nextblock, *dst;
+
+      c_x = _mm_aesenc_si128(c_x, a_x);
+      _mm_store_si128((__m128i *)c, c_x);
+
+      b_x[w] = _mm_xor_si128(b_x[w], c_x);
+      _mm_store_si128((__m128i *)&long_state[a[w][0] & 0x1FFFF0], b_x[w]);
+
+      nextblock = (uint64_t *)&long_state[c[0] & 0x1FFFF0];
+      b[0] = nextblock[0];
+      b[1] = nextblock[1];
+
+      {
+        uint64_t hi, lo;
+
+#if defined(__GNUC__) && defined(__x86_64__)
+        __asm__("mulq %3\n\t"
+          : "=d" (hi),
+          "=a" (lo)
+          : "%a" (c[0]),
+          "rm" (b[0])
+          : "cc" );
 #else
-    aesb_pseudo_round((uint8_t *) &xmminput[0], (uint8_t *) &xmminput[0], (uint8_t *) expkey);
-    aesb_pseudo_round((uint8_t *) &xmminput[1], (uint8_t *) &xmminput[1], (uint8_t *) expkey);
-    aesb_pseudo_round((uint8_t *) &xmminput[2], (uint8_t *) &xmminput[2], (uint8_t *) expkey);
-    aesb_pseudo_round((uint8_t *) &xmminput[3], (uint8_t *) &xmminput[3], (uint8_t *) expkey);
-    aesb_pseudo_round((uint8_t *) &xmminput[4], (uint8_t *) &xmminput[4], (uint8_t *) expkey);
-    aesb_pseudo_round((uint8_t *) &xmminput[5], (uint8_t *) &xmminput[5], (uint8_t *) expkey);
-    aesb_pseudo_round((uint8_t *) &xmminput[6], (uint8_t *) &xmminput[6], (uint8_t *) expkey);
-    aesb_pseudo_round((uint8_t *) &xmminput[7], (uint8_t *) &xmminput[7], (uint8_t *) expkey);
+        lo = mul128(c[0], b[0], &hi);
 #endif
 
+        a[w][0] += hi;
+        a[w][1] += lo;
+      }
+      dst = (uint64_t *) &long_state[c[0] & 0x1FFFF0];
+      dst[0] = a[w][0];
+      dst[1] = a[w][1];
+
+      a[w][0] ^= b[0];
+      a[w][1] ^= b[1];
+      b_x[w] = c_x;
+    }
   }
 
-#if !defined(AESNI)
-  oaes_free((OAES_CTX **) &ctx->aes_ctx);
-#endif
+  for (w = 0; w < ways; w++)
+  {
+    cn_implode_aesni(ctx[w], (char *) hash + w * HASH_SIZE);
+  }
+}
 
-  memcpy(ctx->state.init, ctx->text, INIT_SIZE_BYTE);
-  hash_permutation(&ctx->state.hs);
-  extra_hashes[ctx->state.hs.b[0] & 3](&ctx->state, 200, hash);
+static void cn_slow_hash_aesni_2way(void *context, const void *const *data, size_t length, void *hash)
+{
+  cn_slow_hash_aesni_ways(context, 2, data, length, hash);
+}
+
+static void cn_slow_hash_aesni_4way(void *context, const void *const *data, size_t length, void *hash)
+{
+  cn_slow_hash_aesni_ways(context, 4, data, length, hash);
 }
+#endif
+
+#undef CN_VARIANT
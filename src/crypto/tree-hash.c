@@ -10,6 +10,19 @@
 
 #include "hash-ops.h"
 
+/* Hashes `count` consecutive pairs of `pairs` into `hashes` as one batch, `data` and `lengths` have room for `count` entries */
+static void hash_pairs(const char (*pairs)[HASH_SIZE], size_t count, char (*hashes)[HASH_SIZE], const void **data, size_t *lengths) {
+  size_t i;
+  if (count == 0) {
+    return;
+  }
+  for (i = 0; i < count; ++i) {
+    data[i] = pairs[2 * i];
+    lengths[i] = 2 * HASH_SIZE;
+  }
+  cn_fast_hash_n(data, lengths, count, (char *) hashes);
+}
+
 void tree_hash(const char (*hashes)[HASH_SIZE], size_t count, char *root_hash) {
   assert(count > 0);
   if (count == 1) {
@@ -17,24 +30,30 @@ void tree_hash(const char (*hashes)[HASH_SIZE], size_t count, char *root_hash) {
   } else if (count == 2) {
     cn_fast_hash(hashes, 2 * HASH_SIZE, root_hash);
   } else {
-    size_t i, j;
+    size_t i;
     size_t cnt = count - 1;
     char (*ints)[HASH_SIZE];
+    char (*next)[HASH_SIZE];
+    char (*swap)[HASH_SIZE];
+    const void **data;
+    size_t *lengths;
     for (i = 1; i < sizeof(size_t); i <<= 1) {
       cnt |= cnt >> i;
     }
     cnt &= ~(cnt >> 1);
     ints = alloca(cnt * HASH_SIZE);
+    next = alloca((cnt >> 1) * HASH_SIZE);
+    data = alloca(cnt * sizeof(const void *));
+    lengths = alloca(cnt * sizeof(size_t));
     memcpy(ints, hashes, (2 * cnt - count) * HASH_SIZE);
-    for (i = 2 * cnt - count, j = 2 * cnt - count; j < cnt; i += 2, ++j) {
-      cn_fast_hash(hashes[i], 64, ints[j]);
-    }
-    assert(i == count);
+    hash_pairs(hashes + 2 * cnt - count, count - cnt, ints + 2 * cnt - count, data, lengths);
+    /* each level is hashed as one batch into the other buffer */
     while (cnt > 2) {
       cnt >>= 1;
-      for (i = 0, j = 0; j < cnt; i += 2, ++j) {
-        cn_fast_hash(ints[i], 64, ints[j]);
-      }
+      hash_pairs(ints, cnt, next, data, lengths);
+      swap = ints;
+      ints = next;
+      next = swap;
     }
     cn_fast_hash(ints[0], 64, root_hash);
   }
@@ -54,10 +73,14 @@ size_t tree_depth(size_t count) {
 }
 
 void tree_branch(const char (*hashes)[HASH_SIZE], size_t count, char (*branch)[HASH_SIZE]) {
-  size_t i, j;
+  size_t i;
   size_t cnt = 1;
   size_t depth = 0;
   char (*ints)[HASH_SIZE];
+  char (*next)[HASH_SIZE];
+  char (*swap)[HASH_SIZE];
+  const void **data;
+  size_t *lengths;
   assert(count > 0);
   for (i = sizeof(size_t) << 2; i > 0; i >>= 1) {
     if (cnt << i <= count) {
@@ -68,19 +91,20 @@ void tree_branch(const char (*hashes)[HASH_SIZE], size_t count, char (*branch)[H
   assert(cnt == 1ULL << depth);
   assert(depth == tree_depth(count));
   ints = alloca((cnt - 1) * HASH_SIZE);
+  next = alloca((cnt >> 1) * HASH_SIZE);
+  data = alloca(cnt * sizeof(const void *));
+  lengths = alloca(cnt * sizeof(size_t));
   memcpy(ints, hashes + 1, (2 * cnt - count - 1) * HASH_SIZE);
-  for (i = 2 * cnt - count, j = 2 * cnt - count - 1; j < cnt - 1; i += 2, ++j) {
-    cn_fast_hash(hashes[i], 2 * HASH_SIZE, ints[j]);
-  }
-  assert(i == count);
+  hash_pairs(hashes + 2 * cnt - count, count - cnt, ints + 2 * cnt - count - 1, data, lengths);
   while (depth > 0) {
     assert(cnt == 1ULL << depth);
     cnt >>= 1;
     --depth;
     memcpy(branch[depth], ints[0], HASH_SIZE);
-    for (i = 1, j = 0; j < cnt - 1; i += 2, ++j) {
-      cn_fast_hash(ints[i], 2 * HASH_SIZE, ints[j]);
-    }
+    hash_pairs(ints + 1, cnt - 1, next, data, lengths);
+    swap = ints;
+    ints = next;
+    next = swap;
   }
 }
 
@@ -91,6 +91,7 @@ const uint8_t  BLOCK_MINOR_VERSION_1                         =  1;
 const size_t   BLOCKS_IDS_SYNCHRONIZING_DEFAULT_COUNT        =  10000;  //by default, blocks ids count in synchronizing
 const size_t   BLOCKS_SYNCHRONIZING_DEFAULT_COUNT            =  200;    //by default, blocks count in blocks downloading
 const size_t   COMMAND_RPC_GET_BLOCKS_FAST_MAX_COUNT         =  1000;
+const size_t   OUTPUT_KEY_CACHE_SIZE                         =  65536;  //prepared ring member keys kept for signature checks, 320 bytes each
 
 const int      P2P_DEFAULT_PORT                              = 42080;
 const int      RPC_DEFAULT_PORT                              = 42081;
@@ -0,0 +1,84 @@
+// Copyright (c) 2011-2015 The Cryptonote developers
+// Copyright (c) 2014-2015 XDN developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "BlockHashingBlob.h"
+
+#include <cassert>
+#include <cstring>
+
+#include "cryptonote_core/cryptonote_format_utils.h"
+#include "serialization/binary_archive.h"
+
+namespace cryptonote {
+
+namespace {
+
+//the nonce is the last field of the serialized header and is written as a fixed size little endian integer
+bool findNonceOffset(const blobdata& blob, size_t& offset) {
+  BlockHeader header;
+  memory_binary_archive<false> archive(blob);
+  //the tree hash and transaction count follow the header, so the stream is not expected to be at its end
+  if (!do_serialize(archive, header) || !archive.stream().good()) {
+    return false;
+  }
+
+  offset = blob.size() - archive.remaining_bytes() - sizeof(header.nonce);
+  return true;
+}
+
+}
+
+BlockHashingBlob::BlockHashingBlob() : m_nonceOffset(0) {
+}
+
+bool BlockHashingBlob::init(const Block& block) {
+  blobdata blob;
+  size_t nonceOffset;
+  if (!get_block_hashing_blob(block, blob) || !findNonceOffset(blob, nonceOffset)) {
+    return false;
+  }
+
+  m_blob.swap(blob);
+  m_nonceOffset = nonceOffset;
+  assert(getNonce() == block.nonce);
+  return true;
+}
+
+bool BlockHashingBlob::init(const blobdata& hashingBlob) {
+  size_t nonceOffset;
+  if (!findNonceOffset(hashingBlob, nonceOffset)) {
+    return false;
+  }
+
+  m_blob = hashingBlob;
+  m_nonceOffset = nonceOffset;
+  return true;
+}
+
+uint32_t BlockHashingBlob::getNonce() const {
+  assert(m_nonceOffset + sizeof(uint32_t) <= m_blob.size());
+  uint8_t bytes[sizeof(uint32_t)];
+  memcpy(bytes, m_blob.data() + m_nonceOffset, sizeof(bytes));
+  return static_cast<uint32_t>(bytes[0]) | static_cast<uint32_t>(bytes[1]) << 8 |
+    static_cast<uint32_t>(bytes[2]) << 16 | static_cast<uint32_t>(bytes[3]) << 24;
+}
+
+void BlockHashingBlob::setNonce(uint32_t nonce) {
+  assert(m_nonceOffset + sizeof(uint32_t) <= m_blob.size());
+  m_blob[m_nonceOffset] = static_cast<char>(nonce);
+  m_blob[m_nonceOffset + 1] = static_cast<char>(nonce >> 8);
+  m_blob[m_nonceOffset + 2] = static_cast<char>(nonce >> 16);
+  m_blob[m_nonceOffset + 3] = static_cast<char>(nonce >> 24);
+}
+
+void BlockHashingBlob::getLongHash(crypto::cn_context& context, crypto::hash& hash) const {
+  crypto::cn_slow_hash(context, m_blob.data(), m_blob.size(), hash);
+}
+
+const blobdata& BlockHashingBlob::getBlob() const {
+  return m_blob;
+}
+
+} //namespace cryptonote
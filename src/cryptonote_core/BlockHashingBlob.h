@@ -0,0 +1,39 @@
+// Copyright (c) 2011-2015 The Cryptonote developers
+// Copyright (c) 2014-2015 XDN developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "crypto/hash.h"
+#include "cryptonote_core/cryptonote_basic.h"
+#include "cryptonote_protocol/blobdatatype.h"
+
+namespace cryptonote {
+
+//Hashing blob of a block template, built once; trying a nonce only rewrites its four bytes in place.
+//Copies are independent, so each mining thread keeps its own.
+class BlockHashingBlob {
+public:
+  BlockHashingBlob();
+
+  //builds the blob with get_block_hashing_blob
+  bool init(const Block& block);
+  //takes a ready hashing blob (e.g. a pool job) and locates the nonce by parsing its header
+  bool init(const blobdata& hashingBlob);
+
+  uint32_t getNonce() const;
+  void setNonce(uint32_t nonce);
+
+  void getLongHash(crypto::cn_context& context, crypto::hash& hash) const;
+  const blobdata& getBlob() const;
+
+private:
+  blobdata m_blob;
+  size_t m_nonceOffset;
+};
+
+} //namespace cryptonote
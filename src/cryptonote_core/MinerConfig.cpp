@@ -13,16 +13,22 @@ namespace {
 const command_line::arg_descriptor<std::string> arg_extra_messages =  {"extra-messages-file", "Specify file for extra messages to include into coinbase transactions", "", true};
 const command_line::arg_descriptor<std::string> arg_start_mining =    {"start-mining", "Specify wallet address to mining for", "", true};
 const command_line::arg_descriptor<uint32_t>    arg_mining_threads =  {"mining-threads", "Specify mining threads count", 0, true};
+const command_line::arg_descriptor<bool>        arg_pin_mining_threads = {"pin-mining-threads", "Bind each mining thread to its own CPU core, its hash memory then comes from that core's NUMA node"};
+const command_line::arg_descriptor<uint32_t>    arg_mining_ways =     {"mining-ways", "Specify how many hashes each mining thread computes at once (1, 2 or 4), 0 to choose from the CPU", 0, true};
 }
 
 MinerConfig::MinerConfig() {
   miningThreads = 0;
+  miningWays = 0;
+  pinMiningThreads = false;
 }
 
 void MinerConfig::initOptions(boost::program_options::options_description& desc) {
   command_line::add_arg(desc, arg_extra_messages);
   command_line::add_arg(desc, arg_start_mining);
   command_line::add_arg(desc, arg_mining_threads);
+  command_line::add_arg(desc, arg_mining_ways);
+  command_line::add_arg(desc, arg_pin_mining_threads);
 }
 
 void MinerConfig::init(const boost::program_options::variables_map& options) {
@@ -37,6 +43,12 @@ void MinerConfig::init(const boost::program_options::variables_map& options) {
   if (command_line::has_arg(options, arg_mining_threads)) {
     miningThreads = command_line::get_arg(options, arg_mining_threads);
   }
+
+  if (command_line::has_arg(options, arg_mining_ways)) {
+    miningWays = command_line::get_arg(options, arg_mining_ways);
+  }
+
+  pinMiningThreads = command_line::get_arg(options, arg_pin_mining_threads);
 }
 
 } //namespace cryptonote
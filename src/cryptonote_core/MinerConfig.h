@@ -22,6 +22,8 @@ public:
   std::string extraMessages;
   std::string startMining;
   uint32_t miningThreads;
+  uint32_t miningWays;
+  bool pinMiningThreads;
 };
 
 } //namespace cryptonote
@@ -0,0 +1,338 @@
+// Copyright (c) 2011-2015 The Cryptonote developers
+// Copyright (c) 2014-2015 XDN developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "MiningBenchmark.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <ctime>
+#include <iomanip>
+#include <thread>
+
+// epee
+#include "include_base_utils.h"
+#include "misc_language.h"
+
+#include "common/command_line.h"
+#include "cryptonote_core/account.h"
+#include "cryptonote_core/miner.h"
+
+namespace cryptonote {
+
+namespace {
+const command_line::arg_descriptor<bool>                     arg_benchmark_mining =        {"benchmark-mining", "Benchmark mining and proof of work verification on a synthetic block and exit"};
+const command_line::arg_descriptor<std::vector<uint32_t>>    arg_benchmark_threads =       {"benchmark-threads", "Thread count to benchmark, repeatable (default: 1 and all cores)"};
+const command_line::arg_descriptor<std::vector<uint32_t>>    arg_benchmark_ways =          {"benchmark-ways", "Ways to benchmark (1, 2 or 4), repeatable (default: all)"};
+const command_line::arg_descriptor<std::vector<std::string>> arg_benchmark_huge_pages =    {"benchmark-huge-pages", "Huge page setting to benchmark (on or off), repeatable (default: both)"};
+const command_line::arg_descriptor<std::vector<std::string>> arg_benchmark_pinning =       {"benchmark-pinning", "Thread pinning to benchmark (none, compact or spread), repeatable (default: all)"};
+const command_line::arg_descriptor<uint32_t>                 arg_benchmark_seconds =       {"benchmark-seconds", "Seconds each mining configuration runs", 5};
+const command_line::arg_descriptor<uint32_t>                 arg_benchmark_verifications = {"benchmark-verifications", "Proof of work checks timed for the latency percentiles", 200};
+
+double elapsedSeconds(std::chrono::steady_clock::time_point start, std::chrono::steady_clock::time_point end) {
+  return std::chrono::duration<double>(end - start).count();
+}
+
+double percentile(const std::vector<double>& sorted, size_t percent) {
+  return sorted[std::min(sorted.size() - 1, sorted.size() * percent / 100)];
+}
+}
+
+MiningBenchmarkConfig::MiningBenchmarkConfig() :
+  enabled(false),
+  ways({1, 2, 4}),
+  hugePages({true, false}),
+  pinnings({MiningBenchmarkPinning::NONE, MiningBenchmarkPinning::COMPACT, MiningBenchmarkPinning::SPREAD}),
+  duration(std::chrono::seconds(5)),
+  verifications(200) {
+  uint32_t cores = std::max<uint32_t>(std::thread::hardware_concurrency(), 1);
+  threadCounts.push_back(1);
+  if (cores > 1) {
+    threadCounts.push_back(cores);
+  }
+}
+
+void MiningBenchmarkConfig::initOptions(boost::program_options::options_description& desc) {
+  command_line::add_arg(desc, arg_benchmark_mining);
+  command_line::add_arg(desc, arg_benchmark_threads);
+  command_line::add_arg(desc, arg_benchmark_ways);
+  command_line::add_arg(desc, arg_benchmark_huge_pages);
+  command_line::add_arg(desc, arg_benchmark_pinning);
+  command_line::add_arg(desc, arg_benchmark_seconds);
+  command_line::add_arg(desc, arg_benchmark_verifications);
+}
+
+bool MiningBenchmarkConfig::init(const boost::program_options::variables_map& options) {
+  enabled = command_line::get_arg(options, arg_benchmark_mining);
+
+  if (command_line::has_arg(options, arg_benchmark_threads)) {
+    threadCounts = command_line::get_arg(options, arg_benchmark_threads);
+  }
+
+  if (command_line::has_arg(options, arg_benchmark_ways)) {
+    ways = command_line::get_arg(options, arg_benchmark_ways);
+  }
+
+  if (command_line::has_arg(options, arg_benchmark_huge_pages)) {
+    hugePages.clear();
+    for (const std::string& value : command_line::get_arg(options, arg_benchmark_huge_pages)) {
+      if (value != "on" && value != "off") {
+        LOG_ERROR("Unknown huge page setting " << value << ", expected on or off");
+        return false;
+      }
+      hugePages.push_back(value == "on");
+    }
+  }
+
+  if (command_line::has_arg(options, arg_benchmark_pinning)) {
+    pinnings.clear();
+    for (const std::string& value : command_line::get_arg(options, arg_benchmark_pinning)) {
+      if (value == "none") {
+        pinnings.push_back(MiningBenchmarkPinning::NONE);
+      } else if (value == "compact") {
+        pinnings.push_back(MiningBenchmarkPinning::COMPACT);
+      } else if (value == "spread") {
+        pinnings.push_back(MiningBenchmarkPinning::SPREAD);
+      } else {
+        LOG_ERROR("Unknown pinning " << value << ", expected none, compact or spread");
+        return false;
+      }
+    }
+  }
+
+  duration = std::chrono::seconds(command_line::get_arg(options, arg_benchmark_seconds));
+  verifications = command_line::get_arg(options, arg_benchmark_verifications);
+  return true;
+}
+
+MiningBenchmark::MiningBenchmark(const Currency& currency, const MiningBenchmarkConfig& config) :
+  m_currency(currency),
+  m_config(config),
+  m_template(boost::value_initialized<Block>()) {
+}
+
+bool MiningBenchmark::run() {
+  for (uint32_t ways : m_config.ways) {
+    if (ways == 0 || ways > crypto::CN_SLOW_HASH_MAX_WAYS || (ways & (ways - 1)) != 0) {
+      LOG_ERROR("Mining ways must be 1, 2 or 4, got " << ways);
+      return false;
+    }
+  }
+
+  for (uint32_t threads : m_config.threadCounts) {
+    if (threads == 0) {
+      LOG_ERROR("Benchmark thread count must be positive");
+      return false;
+    }
+  }
+
+  if (!createTemplate()) {
+    return false;
+  }
+
+  m_miningResults.clear();
+  m_verificationResults.clear();
+  for (uint32_t threads : m_config.threadCounts) {
+    for (uint32_t ways : m_config.ways) {
+      for (bool hugePages : m_config.hugePages) {
+        for (MiningBenchmarkPinning pinning : m_config.pinnings) {
+          m_miningResults.push_back(runMining(threads, ways, hugePages, pinning));
+          const MiningBenchmarkResult& result = m_miningResults.back();
+          LOG_PRINT_L1("Benchmarked " << threads << " threads, " << ways << " ways, " << result.memoryBacking <<
+            ", pinning " << pinningName(pinning) << ": " << result.hashesPerSecond << " H/s");
+        }
+      }
+    }
+  }
+
+  if (m_config.verifications != 0) {
+    for (bool hugePages : m_config.hugePages) {
+      VerificationBenchmarkResult result;
+      if (!runVerification(hugePages, result)) {
+        return false;
+      }
+
+      m_verificationResults.push_back(result);
+    }
+  }
+
+  return true;
+}
+
+void MiningBenchmark::print(std::ostream& os) const {
+  os << "Mining" << std::endl;
+  os << std::setw(8) << "threads" << std::setw(6) << "ways" << std::setw(24) << "memory" << std::setw(9) << "pinning" <<
+    std::setw(12) << "H/s" << std::setw(14) << "thread H/s" << std::setw(10) << "stddev" << std::endl;
+  os << std::fixed << std::setprecision(2);
+  for (const MiningBenchmarkResult& result : m_miningResults) {
+    os << std::setw(8) << result.threads << std::setw(6) << result.ways << std::setw(24) << result.memoryBacking <<
+      std::setw(9) << pinningName(result.pinning) << std::setw(12) << result.hashesPerSecond <<
+      std::setw(14) << result.threadHashesPerSecond << std::setw(10) << result.threadStdDeviation << std::endl;
+  }
+
+  if (!m_verificationResults.empty()) {
+    os << std::endl << "Proof of work verification, ms" << std::endl;
+    os << std::setw(24) << "memory" << std::setw(8) << "checks" << std::setw(10) << "median" << std::setw(10) << "p90" <<
+      std::setw(10) << "p99" << std::setw(10) << "max" << std::endl;
+    for (const VerificationBenchmarkResult& result : m_verificationResults) {
+      os << std::setw(24) << result.memoryBacking << std::setw(8) << result.verifications << std::setw(10) << result.medianMs <<
+        std::setw(10) << result.p90Ms << std::setw(10) << result.p99Ms << std::setw(10) << result.maxMs << std::endl;
+    }
+  }
+}
+
+const std::vector<MiningBenchmarkResult>& MiningBenchmark::getMiningResults() const {
+  return m_miningResults;
+}
+
+const std::vector<VerificationBenchmarkResult>& MiningBenchmark::getVerificationResults() const {
+  return m_verificationResults;
+}
+
+const char* MiningBenchmark::pinningName(MiningBenchmarkPinning pinning) {
+  switch (pinning) {
+  case MiningBenchmarkPinning::COMPACT:
+    return "compact";
+  case MiningBenchmarkPinning::SPREAD:
+    return "spread";
+  default:
+    return "none";
+  }
+}
+
+bool MiningBenchmark::createTemplate() {
+  account_base account;
+  account.generate();
+
+  m_template.majorVersion = BLOCK_MAJOR_VERSION_1;
+  m_template.minorVersion = BLOCK_MINOR_VERSION_0;
+  m_template.timestamp = time(nullptr);
+  m_template.prevId = crypto::rand<crypto::hash>();
+  if (!m_currency.constructMinerTx(0, 0, 0, 0, 0, account.get_keys().m_account_address, m_template.minerTx)) {
+    LOG_ERROR("Failed to construct the benchmark miner transaction");
+    return false;
+  }
+
+  //a template with a few transactions, like a live one
+  for (size_t i = 0; i < 10; ++i) {
+    m_template.txHashes.push_back(crypto::rand<crypto::hash>());
+  }
+
+  return m_templateBlob.init(m_template);
+}
+
+MiningBenchmarkResult MiningBenchmark::runMining(uint32_t threads, uint32_t ways, bool hugePages, MiningBenchmarkPinning pinning) {
+  MiningBenchmarkResult result;
+  result.threads = threads;
+  result.ways = ways;
+  result.hugePages = hugePages;
+  result.pinning = pinning;
+
+  uint32_t cores = std::max<uint32_t>(std::thread::hardware_concurrency(), 1);
+  uint32_t spreadStep = std::max<uint32_t>(cores / threads, 1);
+  std::vector<uint64_t> hashes(threads, 0);
+  std::vector<double> seconds(threads, 0);
+  std::atomic<uint32_t> readyThreads(0);
+  std::atomic<bool> started(false);
+  std::atomic<bool> stopped(false);
+  std::chrono::steady_clock::time_point startTime;
+
+  std::vector<std::thread> workers;
+  for (uint32_t index = 0; index < threads; ++index) {
+    workers.emplace_back([&, index] {
+      if (pinning != MiningBenchmarkPinning::NONE) {
+        miner::pin_current_thread(pinning == MiningBenchmarkPinning::SPREAD ? index * spreadStep : index);
+      }
+
+      //allocated after pinning, like in the miner, and not timed
+      crypto::cn_context context(ways, hugePages);
+      if (index == 0) {
+        result.memoryBacking = context.get_memory_backing_name();
+      }
+
+      std::vector<BlockHashingBlob> blobs(ways, m_templateBlob);
+      std::vector<const void*> blobData(ways);
+      std::vector<crypto::hash> results(ways);
+      uint32_t nonce = index;
+
+      ++readyThreads;
+      while (!started) {
+        std::this_thread::yield();
+      }
+
+      do {
+        for (size_t w = 0; w < ways; ++w) {
+          blobs[w].setNonce(nonce + static_cast<uint32_t>(w) * threads);
+          blobData[w] = blobs[w].getBlob().data();
+        }
+
+        crypto::cn_slow_hash_ways(context, blobData.data(), blobs[0].getBlob().size(), results.data());
+        nonce += threads * ways;
+        hashes[index] += ways;
+      } while (!stopped);
+
+      seconds[index] = elapsedSeconds(startTime, std::chrono::steady_clock::now());
+    });
+  }
+
+  while (readyThreads != threads) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+
+  startTime = std::chrono::steady_clock::now();
+  started = true;
+  std::this_thread::sleep_for(m_config.duration);
+  stopped = true;
+  for (auto& worker : workers) {
+    worker.join();
+  }
+
+  std::vector<double> rates(threads);
+  result.hashesPerSecond = 0;
+  for (uint32_t index = 0; index < threads; ++index) {
+    rates[index] = hashes[index] / seconds[index];
+    result.hashesPerSecond += rates[index];
+  }
+
+  result.threadHashesPerSecond = result.hashesPerSecond / threads;
+  double variance = 0;
+  for (double rate : rates) {
+    variance += (rate - result.threadHashesPerSecond) * (rate - result.threadHashesPerSecond);
+  }
+
+  result.threadStdDeviation = std::sqrt(variance / threads);
+  return result;
+}
+
+bool MiningBenchmark::runVerification(bool hugePages, VerificationBenchmarkResult& result) {
+  crypto::cn_context context(1, hugePages);
+  result.hugePages = hugePages;
+  result.memoryBacking = context.get_memory_backing_name();
+  result.verifications = m_config.verifications;
+
+  //difficulty 1 accepts every hash, so each check does the full work of a valid block
+  Block block = m_template;
+  std::vector<double> latencies;
+  for (uint32_t i = 0; i < m_config.verifications; ++i) {
+    block.nonce = i;
+    crypto::hash proofOfWork;
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    bool checked = m_currency.checkProofOfWork(context, block, 1, proofOfWork);
+    latencies.push_back(elapsedSeconds(start, std::chrono::steady_clock::now()) * 1000);
+    if (!checked) {
+      LOG_ERROR("Proof of work check failed on the benchmark block");
+      return false;
+    }
+  }
+
+  std::sort(latencies.begin(), latencies.end());
+  result.medianMs = percentile(latencies, 50);
+  result.p90Ms = percentile(latencies, 90);
+  result.p99Ms = percentile(latencies, 99);
+  result.maxMs = latencies.back();
+  return true;
+}
+
+} //namespace cryptonote
@@ -0,0 +1,93 @@
+// Copyright (c) 2011-2015 The Cryptonote developers
+// Copyright (c) 2014-2015 XDN developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include <boost/program_options.hpp>
+
+#include "cryptonote_core/BlockHashingBlob.h"
+#include "cryptonote_core/cryptonote_basic.h"
+#include "cryptonote_core/Currency.h"
+
+namespace cryptonote {
+
+enum class MiningBenchmarkPinning {
+  NONE,
+  COMPACT, //thread i on core i
+  SPREAD   //threads evenly spaced over all cores
+};
+
+class MiningBenchmarkConfig {
+public:
+  MiningBenchmarkConfig();
+
+  static void initOptions(boost::program_options::options_description& desc);
+  //fails on unknown huge page or pinning values
+  bool init(const boost::program_options::variables_map& options);
+
+  bool enabled;
+  std::vector<uint32_t> threadCounts;
+  std::vector<uint32_t> ways;
+  std::vector<bool> hugePages;
+  std::vector<MiningBenchmarkPinning> pinnings;
+  std::chrono::milliseconds duration; //of each mining configuration
+  uint32_t verifications;
+};
+
+struct MiningBenchmarkResult {
+  uint32_t threads;
+  uint32_t ways;
+  bool hugePages;
+  MiningBenchmarkPinning pinning;
+  std::string memoryBacking; //what the first thread really got
+  double hashesPerSecond;
+  double threadHashesPerSecond; //mean of the threads
+  double threadStdDeviation;
+};
+
+struct VerificationBenchmarkResult {
+  bool hugePages;
+  std::string memoryBacking;
+  uint32_t verifications;
+  double medianMs;
+  double p90Ms;
+  double p99Ms;
+  double maxMs;
+};
+
+//Offline hashrate and proof of work verification benchmark against a synthetic block template.
+//Sweeps every combination of thread count, ways, huge pages and pinning in the config.
+class MiningBenchmark {
+public:
+  MiningBenchmark(const Currency& currency, const MiningBenchmarkConfig& config);
+
+  bool run();
+  void print(std::ostream& os) const;
+
+  const std::vector<MiningBenchmarkResult>& getMiningResults() const;
+  const std::vector<VerificationBenchmarkResult>& getVerificationResults() const;
+
+  static const char* pinningName(MiningBenchmarkPinning pinning);
+
+private:
+  bool createTemplate();
+  MiningBenchmarkResult runMining(uint32_t threads, uint32_t ways, bool hugePages, MiningBenchmarkPinning pinning);
+  bool runVerification(bool hugePages, VerificationBenchmarkResult& result);
+
+  const Currency& m_currency;
+  const MiningBenchmarkConfig m_config;
+  Block m_template;
+  BlockHashingBlob m_templateBlob;
+  std::vector<MiningBenchmarkResult> m_miningResults;
+  std::vector<VerificationBenchmarkResult> m_verificationResults;
+};
+
+} //namespace cryptonote
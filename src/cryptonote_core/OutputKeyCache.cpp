@@ -0,0 +1,93 @@
+// Copyright (c) 2011-2015 The Cryptonote developers
+// Copyright (c) 2014-2015 XDN developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "OutputKeyCache.h"
+
+#include <cstring>
+
+namespace cryptonote {
+
+OutputKeyCache::OutputKeyCache(size_t capacity) :
+  m_shardCapacity((capacity + SHARD_COUNT - 1) / SHARD_COUNT),
+  m_hits(0),
+  m_misses(0) {
+}
+
+bool OutputKeyCache::get(const crypto::public_key& key, crypto::prepared_public_key& prepared) {
+  Shard& shard = getShard(key);
+  {
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    auto it = shard.index.find(key);
+    if (it != shard.index.end()) {
+      shard.entries.splice(shard.entries.begin(), shard.entries, it->second);
+      prepared = it->second->second;
+      ++m_hits;
+      return true;
+    }
+  }
+
+  //prepare without holding the lock, a concurrent miss on the same key just does the work twice
+  ++m_misses;
+  if (!crypto::prepare_public_key(key, prepared)) {
+    return false;
+  }
+
+  if (m_shardCapacity == 0) {
+    return true;
+  }
+
+  std::lock_guard<std::mutex> lock(shard.mutex);
+  if (shard.index.count(key) != 0) {
+    return true;
+  }
+
+  if (shard.index.size() >= m_shardCapacity) {
+    shard.index.erase(shard.entries.back().first);
+    shard.entries.pop_back();
+  }
+
+  shard.entries.emplace_front(key, prepared);
+  shard.index.emplace(key, shard.entries.begin());
+  return true;
+}
+
+void OutputKeyCache::clear() {
+  for (Shard& shard : m_shards) {
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    shard.index.clear();
+    shard.entries.clear();
+  }
+}
+
+uint64_t OutputKeyCache::getHits() const {
+  return m_hits;
+}
+
+uint64_t OutputKeyCache::getMisses() const {
+  return m_misses;
+}
+
+size_t OutputKeyCache::size() const {
+  size_t result = 0;
+  for (const Shard& shard : m_shards) {
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    result += shard.index.size();
+  }
+
+  return result;
+}
+
+size_t OutputKeyCache::capacity() const {
+  return m_shardCapacity * SHARD_COUNT;
+}
+
+OutputKeyCache::Shard& OutputKeyCache::getShard(const crypto::public_key& key) {
+  //public keys are uniformly distributed, any of their bytes picks a shard
+  uint8_t firstByte;
+  memcpy(&firstByte, &key, sizeof(firstByte));
+  return m_shards[firstByte % SHARD_COUNT];
+}
+
+} //namespace cryptonote
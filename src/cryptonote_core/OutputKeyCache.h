@@ -0,0 +1,56 @@
+// Copyright (c) 2011-2015 The Cryptonote developers
+// Copyright (c) 2014-2015 XDN developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+
+#include "crypto/crypto.h"
+
+namespace cryptonote {
+
+//Bounded cache of prepared output public keys for ring signature checks.
+//Popular decoys appear in many rings, so their decompression and hash_to_ec are done once.
+//Split in independently locked shards, each evicting its least recently used keys.
+class OutputKeyCache {
+public:
+  explicit OutputKeyCache(size_t capacity);
+
+  //prepares the key on a miss, fails if the key is not a valid point
+  bool get(const crypto::public_key& key, crypto::prepared_public_key& prepared);
+  void clear();
+
+  uint64_t getHits() const;
+  uint64_t getMisses() const;
+  size_t size() const;
+  size_t capacity() const;
+
+private:
+  static const size_t SHARD_COUNT = 16;
+
+  typedef std::list<std::pair<crypto::public_key, crypto::prepared_public_key>> Entries;
+
+  struct Shard {
+    mutable std::mutex mutex;
+    Entries entries; //most recently used first
+    std::unordered_map<crypto::public_key, Entries::iterator> index;
+  };
+
+  Shard& getShard(const crypto::public_key& key);
+
+  const size_t m_shardCapacity;
+  std::array<Shard, SHARD_COUNT> m_shards;
+  std::atomic<uint64_t> m_hits;
+  std::atomic<uint64_t> m_misses;
+};
+
+} //namespace cryptonote
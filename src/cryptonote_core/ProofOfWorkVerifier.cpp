@@ -0,0 +1,96 @@
+// Copyright (c) 2011-2015 The Cryptonote developers
+// Copyright (c) 2014-2015 XDN developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "ProofOfWorkVerifier.h"
+
+#include <algorithm>
+
+#include "cryptonote_core/cryptonote_format_utils.h"
+
+namespace cryptonote {
+
+ProofOfWorkVerifier::ProofOfWorkVerifier(size_t threadCount) :
+  m_threadCount(threadCount != 0 ? threadCount : std::max<size_t>(std::thread::hardware_concurrency(), 1)),
+  m_blocks(nullptr),
+  m_longHashes(nullptr),
+  m_nextBlock(0),
+  m_pendingBlocks(0),
+  m_failed(false),
+  m_stop(false) {
+}
+
+ProofOfWorkVerifier::~ProofOfWorkVerifier() {
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_stop = true;
+  }
+
+  m_workAvailable.notify_all();
+  for (auto& thread : m_threads) {
+    thread.join();
+  }
+}
+
+bool ProofOfWorkVerifier::getLongHashes(const std::vector<Block>& blocks, std::vector<crypto::hash>& longHashes) {
+  std::lock_guard<std::mutex> batchLock(m_batchMutex);
+  longHashes.assign(blocks.size(), crypto::hash());
+  if (blocks.empty()) {
+    return true;
+  }
+
+  std::unique_lock<std::mutex> lock(m_mutex);
+  if (m_threads.empty()) {
+    for (size_t i = 0; i < m_threadCount; ++i) {
+      m_threads.emplace_back(&ProofOfWorkVerifier::workerThread, this);
+    }
+  }
+
+  m_blocks = &blocks;
+  m_longHashes = &longHashes;
+  m_nextBlock = 0;
+  m_pendingBlocks = blocks.size();
+  m_failed = false;
+  m_workAvailable.notify_all();
+
+  m_batchDone.wait(lock, [this] { return m_pendingBlocks == 0; });
+  m_blocks = nullptr;
+  m_longHashes = nullptr;
+  return !m_failed;
+}
+
+size_t ProofOfWorkVerifier::getThreadCount() const {
+  return m_threadCount;
+}
+
+void ProofOfWorkVerifier::workerThread() {
+  crypto::cn_context context;
+
+  std::unique_lock<std::mutex> lock(m_mutex);
+  for (;;) {
+    m_workAvailable.wait(lock, [this] { return m_stop || (m_blocks != nullptr && m_nextBlock < m_blocks->size()); });
+    if (m_stop) {
+      break;
+    }
+
+    size_t index = m_nextBlock++;
+    const Block& block = (*m_blocks)[index];
+    lock.unlock();
+
+    crypto::hash longHash;
+    bool hashed = get_block_longhash(context, block, longHash);
+
+    lock.lock();
+    (*m_longHashes)[index] = longHash;
+    if (!hashed) {
+      m_failed = true;
+    }
+
+    if (--m_pendingBlocks == 0) {
+      m_batchDone.notify_one();
+    }
+  }
+}
+
+} //namespace cryptonote
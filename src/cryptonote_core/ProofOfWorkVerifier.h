@@ -0,0 +1,49 @@
+// Copyright (c) 2011-2015 The Cryptonote developers
+// Copyright (c) 2014-2015 XDN developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "crypto/hash.h"
+#include "cryptonote_core/cryptonote_basic.h"
+
+namespace cryptonote {
+
+//Computes block long hashes on a pool of worker threads, each with its own cn_context.
+//Threads are started on first use and live until the verifier is destroyed.
+class ProofOfWorkVerifier {
+public:
+  //0 threads means one per hardware thread
+  explicit ProofOfWorkVerifier(size_t threadCount = 0);
+  ~ProofOfWorkVerifier();
+
+  //blocks the caller until the whole batch is hashed, batches from several callers are processed one by one
+  bool getLongHashes(const std::vector<Block>& blocks, std::vector<crypto::hash>& longHashes);
+  size_t getThreadCount() const;
+
+private:
+  void workerThread();
+
+  const size_t m_threadCount;
+  std::vector<std::thread> m_threads;
+  std::mutex m_batchMutex;
+
+  std::mutex m_mutex;
+  std::condition_variable m_workAvailable;
+  std::condition_variable m_batchDone;
+  const std::vector<Block>* m_blocks;
+  std::vector<crypto::hash>* m_longHashes;
+  size_t m_nextBlock;
+  size_t m_pendingBlocks;
+  bool m_failed;
+  bool m_stop;
+};
+
+} //namespace cryptonote
@@ -165,6 +165,7 @@ private:
   size_t m_poolSize;
   std::vector<uint64_t> m_offsets;
   uint64_t m_itemsFileSize;
+  std::vector<char> m_readBuffer;
   std::map<uint64_t, ItemEntry> m_items;
   std::list<CacheEntry> m_cache;
   uint64_t m_cacheHits;
@@ -273,9 +274,15 @@ template<class T> const T& SwappedVector<T>::operator[](uint64_t index) {
     throw std::runtime_error("SwappedVector::operator[]");
   }
 
+  uint64_t itemSize = (index + 1 < m_offsets.size() ? m_offsets[index + 1] : m_itemsFileSize) - m_offsets[index];
+  m_readBuffer.resize(static_cast<size_t>(itemSize));
   m_itemsFile.seekg(m_offsets[index]);
+  if (!m_itemsFile.read(m_readBuffer.data(), m_readBuffer.size())) {
+    throw std::runtime_error("SwappedVector::operator[]");
+  }
+
   T tempItem;
-  binary_archive<false> archive(m_itemsFile);
+  memory_binary_archive<false> archive(m_readBuffer.data(), m_readBuffer.size());
   if (!do_serialize(archive, tempItem)) {
     throw std::runtime_error("SwappedVector::operator[]");
   }
@@ -149,6 +149,7 @@ BOOST_CLASS_VERSION(cryptonote::BlockCacheSerializer, CURRENT_BLOCKCACHE_STORAGE
 blockchain_storage::blockchain_storage(const Currency& currency, tx_memory_pool& tx_pool):
       m_currency(currency),
       m_tx_pool(tx_pool),
+      m_outputKeyCache(OUTPUT_KEY_CACHE_SIZE),
       m_current_block_cumul_sz_limit(0),
       m_is_in_checkpoint_zone(false),
       m_is_blockchain_storing(false),
@@ -237,6 +238,7 @@ bool blockchain_storage::init(const std::string& config_folder, bool load_existi
   }
 
   m_config_folder = config_folder;
+  LOG_PRINT_L1("Proof of work hashing uses " << m_cn_context.get_memory_backing_name());
 
   if (!m_blocks.open(appendPath(config_folder, m_currency.blocksFileName()), appendPath(config_folder, m_currency.blockIndexesFileName()), 1024)) {
     return false;
@@ -259,17 +261,37 @@ bool blockchain_storage::init(const std::string& config_folder, bool load_existi
         m_spent_keys.clear();
         m_outputs.clear();
         m_multisignatureOutputs.clear();
+        std::vector<Block> chunkBlocks;
+        std::vector<blobdata> chunkTransactions;
+        std::vector<crypto::hash> blockHashes;
+        std::vector<crypto::hash> transactionHashes;
+        size_t chunkTransaction = 0;
         for (uint32_t b = 0; b < m_blocks.size(); ++b) {
           if (b % 1000 == 0) {
             std::cout << "Height " << b << " of " << m_blocks.size() << '\r';
+
+            //hash the next 1000 blocks and their transactions in batches
+            chunkBlocks.clear();
+            chunkTransactions.clear();
+            for (uint32_t c = b; c < m_blocks.size() && c < b + 1000; ++c) {
+              const BlockEntry& block = m_blocks[c];
+              chunkBlocks.push_back(block.bl);
+              for (const TransactionEntry& transaction : block.transactions) {
+                chunkTransactions.push_back(tx_to_blob(transaction.tx));
+              }
+            }
+
+            get_block_hashes(chunkBlocks, blockHashes);
+            get_blob_hashes(chunkTransactions, transactionHashes);
+            chunkTransaction = 0;
           }
           const BlockEntry& block = m_blocks[b];
-          crypto::hash blockHash = get_block_hash(block.bl);
+          crypto::hash blockHash = blockHashes[b % 1000];
           m_blockIndex.push(blockHash);
           uint64_t interest = 0;
           for (uint16_t t = 0; t < block.transactions.size(); ++t) {
             const TransactionEntry& transaction = block.transactions[t];
-            crypto::hash transactionHash = get_transaction_hash(transaction.tx);
+            crypto::hash transactionHash = transactionHashes[chunkTransaction++];
             TransactionIndex transactionIndex = { b, t };
             m_transactionMap.insert(std::make_pair(transactionHash, transactionIndex));
 
@@ -913,7 +935,7 @@ bool blockchain_storage::handle_alternative_block(const Block& b, const crypto::
     difficulty_type current_diff = get_next_difficulty_for_alternative_chain(alt_chain, bei);
     CHECK_AND_ASSERT_MES(current_diff, false, "!!!!!!! DIFFICULTY OVERHEAD !!!!!!!");
     crypto::hash proof_of_work = null_hash;
-    if (!m_currency.checkProofOfWork(m_cn_context, bei.bl, current_diff, proof_of_work)) {
+    if (!checkProofOfWork(bei.bl, id, current_diff, proof_of_work)) {
       LOG_PRINT_RED_L0("Block with id: " << id
         << ENDL << " for alternative chain, have not enough proof of work: " << proof_of_work
         << ENDL << " expected difficulty: " << current_diff);
@@ -1400,7 +1422,19 @@ bool blockchain_storage::check_tx_input(const TransactionInputToKey& txin, const
     return true;
   }
 
-  return crypto::check_ring_signature(tx_prefix_hash, txin.keyImage, output_keys, sig.data());
+  //ring members come from the cache, popular decoys are not decompressed again for every ring
+  std::vector<crypto::prepared_public_key> prepared_keys(output_keys.size());
+  std::vector<const crypto::prepared_public_key *> prepared_key_ptrs;
+  prepared_key_ptrs.reserve(output_keys.size());
+  for (size_t i = 0; i < output_keys.size(); ++i) {
+    if (!m_outputKeyCache.get(*output_keys[i], prepared_keys[i])) {
+      LOG_PRINT_L0("Output key " << *output_keys[i] << " referenced by input is not a valid point");
+      return false;
+    }
+    prepared_key_ptrs.push_back(&prepared_keys[i]);
+  }
+
+  return crypto::check_ring_signature(tx_prefix_hash, txin.keyImage, prepared_key_ptrs, sig.data());
 }
 
 uint64_t blockchain_storage::get_adjusted_time() {
@@ -1486,6 +1520,55 @@ bool blockchain_storage::checkCumulativeBlockSize(const crypto::hash& blockId, s
   return true;
 }
 
+bool blockchain_storage::checkProofOfWork(const Block& block, const crypto::hash& blockHash, difficulty_type currentDifficulty, crypto::hash& proofOfWork) {
+  auto it = m_precomputedLongHashes.find(blockHash);
+  if (it == m_precomputedLongHashes.end()) {
+    return m_currency.checkProofOfWork(m_cn_context, block, currentDifficulty, proofOfWork);
+  }
+
+  //the block id commits to the hashing blob, so a long hash found by id is the one of this block
+  proofOfWork = it->second;
+  m_precomputedLongHashes.erase(it);
+  return check_hash(proofOfWork, currentDifficulty);
+}
+
+void blockchain_storage::precomputeProofOfWork(const std::vector<Block>& blocks) {
+  //the batch is expected to continue the current tail, that gives the height of each block
+  uint64_t height = get_current_blockchain_height();
+  size_t first = 0;
+  while (first < blocks.size() && m_checkpoints.is_in_checkpoint_zone(height + first)) {
+    ++first;
+  }
+
+  if (first == blocks.size()) {
+    return;
+  }
+
+  std::vector<Block> tail;
+  const std::vector<Block>* batch = &blocks;
+  if (first != 0) {
+    tail.assign(blocks.begin() + first, blocks.end());
+    batch = &tail;
+  }
+
+  TIME_MEASURE_START(longhash_calculating_time);
+  std::vector<crypto::hash> longHashes;
+  if (!m_powVerifier.getLongHashes(*batch, longHashes)) {
+    LOG_PRINT_L1("Failed to precompute proof of work, blocks will be hashed on import");
+    return;
+  }
+  TIME_MEASURE_FINISH(longhash_calculating_time);
+
+  CRITICAL_REGION_LOCAL(m_blockchain_lock);
+  m_precomputedLongHashes.clear();
+  for (size_t i = 0; i < batch->size(); ++i) {
+    m_precomputedLongHashes[get_block_hash((*batch)[i])] = longHashes[i];
+  }
+
+  LOG_PRINT_L2("Proof of work of " << batch->size() << " blocks precomputed in " << longhash_calculating_time <<
+    " ms using " << m_powVerifier.getThreadCount() << " threads");
+}
+
 // Returns true, if cumulativeSize is calculated precisely, else returns false.
 bool blockchain_storage::getBlockCumulativeSize(const Block& block, size_t& cumulativeSize) {
   std::vector<Transaction> blockTxs;
@@ -1598,7 +1681,7 @@ bool blockchain_storage::pushBlock(const Block& blockData, block_verification_co
       return false;
     }
   } else {
-    if (!m_currency.checkProofOfWork(m_cn_context, blockData, currentDifficulty, proof_of_work)) {
+    if (!checkProofOfWork(blockData, blockHash, currentDifficulty, proof_of_work)) {
       LOG_PRINT_L0("Block " << blockHash << ", has too weak proof of work: " << proof_of_work << ", expected difficulty: " << currentDifficulty);
       bvc.m_verifivation_failed = true;
       return false;
@@ -14,9 +14,11 @@
 #include "common/util.h"
 #include "cryptonote_core/BlockIndex.h"
 #include "cryptonote_core/checkpoints.h"
+#include "cryptonote_core/ProofOfWorkVerifier.h"
 #include "cryptonote_core/Currency.h"
 #include "cryptonote_core/IBlockchainStorageObserver.h"
 #include "cryptonote_core/ITransactionValidator.h"
+#include "cryptonote_core/OutputKeyCache.h"
 #include "cryptonote_core/SwappedVector.h"
 #include "cryptonote_core/UpgradeDetector.h"
 #include "cryptonote_core/cryptonote_format_utils.h"
@@ -53,6 +55,7 @@ namespace cryptonote {
     bool getBlockIds(uint64_t startHeight, size_t maxCount, std::list<crypto::hash>& items);
 
     void set_checkpoints(checkpoints&& chk_pts) { m_checkpoints = chk_pts; }
+    const OutputKeyCache& getOutputKeyCache() const { return m_outputKeyCache; }
     bool get_blocks(uint64_t start_offset, size_t count, std::list<Block>& blocks, std::list<Transaction>& txs);
     bool get_blocks(uint64_t start_offset, size_t count, std::list<Block>& blocks);
     bool get_alternative_blocks(std::list<Block>& blocks);
@@ -71,6 +74,8 @@ namespace cryptonote {
     uint64_t getCoinsInCirculation();
     uint8_t get_block_major_version_for_height(uint64_t height) const;
     bool add_new_block(const Block& bl_, block_verification_context& bvc);
+    //hashes a downloaded batch on the worker pool ahead of add_new_block, blocks inside the checkpoint zone are skipped
+    void precomputeProofOfWork(const std::vector<Block>& blocks);
     bool reset_and_set_genesis_block(const Block& b);
     bool create_block_template(Block& b, const AccountPublicAddress& miner_address, difficulty_type& di, uint64_t& height, const blobdata& ex_nonce);
     bool have_block(const crypto::hash& id);
@@ -192,6 +197,9 @@ namespace cryptonote {
     tx_memory_pool& m_tx_pool;
     mutable epee::critical_section m_blockchain_lock; // TODO: add here reader/writer lock
     crypto::cn_context m_cn_context;
+    ProofOfWorkVerifier m_powVerifier;
+    std::unordered_map<crypto::hash, crypto::hash> m_precomputedLongHashes; //block id -> long hash
+    OutputKeyCache m_outputKeyCache;
     tools::ObserverManager<IBlockchainStorageObserver> m_observerManager;
 
     key_images_container m_spent_keys;
@@ -237,6 +245,7 @@ namespace cryptonote {
     uint64_t get_adjusted_time();
     bool complete_timestamps_vector(uint64_t start_height, std::vector<uint64_t>& timestamps);
     bool checkBlockVersion(const Block& b, const crypto::hash& blockHash);
+    bool checkProofOfWork(const Block& block, const crypto::hash& blockHash, difficulty_type currentDifficulty, crypto::hash& proofOfWork);
     bool checkCumulativeBlockSize(const crypto::hash& blockId, size_t cumulativeBlockSize, uint64_t height);
     bool getBlockCumulativeSize(const Block& block, size_t& cumulativeSize);
     bool update_next_comulative_size_limit();
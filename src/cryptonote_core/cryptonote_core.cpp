@@ -375,6 +375,10 @@ namespace cryptonote
     return m_blockchain_storage.get_tx_outputs_gindexs(tx_id, indexs);
   }
   //-----------------------------------------------------------------------------------------------
+  void core::precompute_proof_of_work(const std::vector<Block>& blocks) {
+    m_blockchain_storage.precomputeProofOfWork(blocks);
+  }
+  //-----------------------------------------------------------------------------------------------
   void core::pause_mining() {
     m_miner->pause();
   }
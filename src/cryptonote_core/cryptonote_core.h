@@ -38,6 +38,7 @@ namespace cryptonote {
      bool on_idle();
      virtual bool handle_incoming_tx(const blobdata& tx_blob, tx_verification_context& tvc, bool keeped_by_block);
      bool handle_incoming_block_blob(const blobdata& block_blob, block_verification_context& bvc, bool control_miner, bool relay_block);
+     void precompute_proof_of_work(const std::vector<Block>& blocks);
      const Currency& currency() const { return m_currency; }
      virtual i_cryptonote_protocol* get_protocol(){return m_pprotocol;}
 
@@ -39,9 +39,7 @@ namespace cryptonote
   //---------------------------------------------------------------
   bool parse_and_validate_tx_from_blob(const blobdata& tx_blob, Transaction& tx)
   {
-    std::stringstream ss;
-    ss << tx_blob;
-    binary_archive<false> ba(ss);
+    memory_binary_archive<false> ba(tx_blob);
     bool r = ::serialization::serialize(ba, tx);
     CHECK_AND_ASSERT_MES(r, false, "Failed to parse transaction from blob");
     return true;
@@ -49,9 +47,7 @@ namespace cryptonote
   //---------------------------------------------------------------
   bool parse_and_validate_tx_from_blob(const blobdata& tx_blob, Transaction& tx, crypto::hash& tx_hash, crypto::hash& tx_prefix_hash)
   {
-    std::stringstream ss;
-    ss << tx_blob;
-    binary_archive<false> ba(ss);
+    memory_binary_archive<false> ba(tx_blob);
     bool r = ::serialization::serialize(ba, tx);
     CHECK_AND_ASSERT_MES(r, false, "Failed to parse transaction from blob");
     //TODO: validate tx
@@ -93,9 +89,7 @@ namespace cryptonote
     if(tx_extra.empty())
       return true;
 
-    std::string extra_str(reinterpret_cast<const char*>(tx_extra.data()), tx_extra.size());
-    std::istringstream iss(extra_str);
-    binary_archive<false> ar(iss);
+    memory_binary_archive<false> ar(tx_extra.data(), tx_extra.size());
 
     bool eof = false;
     while (!eof) {
@@ -108,9 +102,9 @@ namespace cryptonote
       }
       tx_extra_fields.push_back(field);
 
-      std::ios_base::iostate state = iss.rdstate();
-      eof = (EOF == iss.peek());
-      iss.clear(state);
+      std::ios_base::iostate state = ar.stream().rdstate();
+      eof = (EOF == ar.stream().peek());
+      ar.stream().clear(state);
     }
     
     if (!::serialization::check_stream_state(ar)) {
@@ -585,6 +579,19 @@ namespace cryptonote
     return h;
   }
   //---------------------------------------------------------------
+  void get_blob_hashes(const std::vector<blobdata>& blobs, std::vector<crypto::hash>& hashes)
+  {
+    std::vector<const void*> data(blobs.size());
+    std::vector<size_t> lengths(blobs.size());
+    for (size_t i = 0; i < blobs.size(); ++i) {
+      data[i] = blobs[i].data();
+      lengths[i] = blobs[i].size();
+    }
+
+    hashes.resize(blobs.size());
+    crypto::cn_fast_hash_n(data.data(), lengths.data(), blobs.size(), hashes.data());
+  }
+  //---------------------------------------------------------------
   crypto::hash get_transaction_hash(const Transaction& t)
   {
     crypto::hash h = null_hash;
@@ -604,17 +611,30 @@ namespace cryptonote
     return get_object_hash(t, res, blob_size);
   }
   //---------------------------------------------------------------
-  bool get_block_hashing_blob(const Block& b, blobdata& blob) {
+  static bool get_block_hashing_blob(const Block& b, const crypto::hash& miner_tx_hash, blobdata& blob) {
     if (!t_serializable_object_to_blob(static_cast<const BlockHeader&>(b), blob)) {
       return false;
     }
-    crypto::hash tree_root_hash = get_tx_tree_hash(b);
+    std::vector<crypto::hash> txs_ids;
+    txs_ids.reserve(b.txHashes.size() + 1);
+    txs_ids.push_back(miner_tx_hash);
+    txs_ids.insert(txs_ids.end(), b.txHashes.begin(), b.txHashes.end());
+    crypto::hash tree_root_hash = get_tx_tree_hash(txs_ids);
     blob.append(reinterpret_cast<const char*>(&tree_root_hash), sizeof(tree_root_hash));
     blob.append(tools::get_varint_data(b.txHashes.size() + 1));
 
     return true;
   }
   //---------------------------------------------------------------
+  bool get_block_hashing_blob(const Block& b, blobdata& blob) {
+    crypto::hash miner_tx_hash = null_hash;
+    if (!get_transaction_hash(b.minerTx, miner_tx_hash)) {
+      return false;
+    }
+
+    return get_block_hashing_blob(b, miner_tx_hash, blob);
+  }
+  //---------------------------------------------------------------
   bool get_block_hash(const Block& b, crypto::hash& res) {
     blobdata blob;
     if (!get_block_hashing_blob(b, blob)) {
@@ -630,6 +650,33 @@ namespace cryptonote
     return p;
   }
   //---------------------------------------------------------------
+  bool get_block_hashes(const std::vector<Block>& blocks, std::vector<crypto::hash>& hashes) {
+    //miner transactions first, then the hashing blobs that depend on them, each as one batch
+    std::vector<blobdata> blobs(blocks.size());
+    for (size_t i = 0; i < blocks.size(); ++i) {
+      if (!tx_to_blob(blocks[i].minerTx, blobs[i])) {
+        return false;
+      }
+    }
+
+    std::vector<crypto::hash> miner_tx_hashes;
+    get_blob_hashes(blobs, miner_tx_hashes);
+    for (size_t i = 0; i < blocks.size(); ++i) {
+      blobdata hashing_blob;
+      if (!get_block_hashing_blob(blocks[i], miner_tx_hashes[i], hashing_blob)) {
+        return false;
+      }
+
+      //like get_block_hash, the id is the hash of the serialized hashing blob
+      if (!t_serializable_object_to_blob(hashing_blob, blobs[i])) {
+        return false;
+      }
+    }
+
+    get_blob_hashes(blobs, hashes);
+    return true;
+  }
+  //---------------------------------------------------------------
   bool get_aux_block_header_hash(const Block& b, crypto::hash& res) {
     blobdata blob;
     if (!get_block_hashing_blob(b, blob)) {
@@ -671,9 +718,7 @@ namespace cryptonote
   //---------------------------------------------------------------
   bool parse_and_validate_block_from_blob(const blobdata& b_blob, Block& b)
   {
-    std::stringstream ss;
-    ss << b_blob;
-    binary_archive<false> ba(ss);
+    memory_binary_archive<false> ba(b_blob);
     bool r = ::serialization::serialize(ba, b);
     CHECK_AND_ASSERT_MES(r, false, "Failed to parse block from blob");
     return true;
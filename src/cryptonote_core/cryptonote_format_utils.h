@@ -85,6 +85,8 @@ namespace cryptonote
   bool generate_key_image_helper(const account_keys& ack, const crypto::public_key& tx_public_key, size_t real_output_index, KeyPair& in_ephemeral, crypto::key_image& ki);
   void get_blob_hash(const blobdata& blob, crypto::hash& res);
   crypto::hash get_blob_hash(const blobdata& blob);
+  //hashes all blobs as one batch
+  void get_blob_hashes(const std::vector<blobdata>& blobs, std::vector<crypto::hash>& hashes);
   std::string short_hash_str(const crypto::hash& h);
   bool createTxExtraWithPaymentId(const std::string& paymentIdString, std::vector<uint8_t>& extra);
   //returns false if payment id is not found or parse error
@@ -98,6 +100,7 @@ namespace cryptonote
   bool get_aux_block_header_hash(const Block& b, crypto::hash& res);
   bool get_block_hash(const Block& b, crypto::hash& res);
   crypto::hash get_block_hash(const Block& b);
+  bool get_block_hashes(const std::vector<Block>& blocks, std::vector<crypto::hash>& hashes);
   bool get_block_longhash(crypto::cn_context &context, const Block& b, crypto::hash& res);
   bool parse_and_validate_block_from_blob(const blobdata& b_blob, Block& b);
   uint64_t get_outs_money_amount(const Transaction& tx);
@@ -216,8 +216,8 @@ void serialize(Transaction& tx, const std::string& name, ISerializer& serializer
       tx.signatures[i].resize(signatureSize);
     }
 
-    for (crypto::signature& sig: tx.signatures[i]) {
-      serializePod(sig, "", serializer);
+    if (!tx.signatures[i].empty()) {
+      serializer.binaryItems(tx.signatures[i].data(), sizeof(crypto::signature), tx.signatures[i].size());
     }
   }
 //  serializer.endArray();
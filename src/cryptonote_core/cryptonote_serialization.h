@@ -6,9 +6,16 @@
 #pragma once
 
 #include "cryptonote_basic.h"
+#include "serialization/SerializationOverloads.h"
 
 namespace cryptonote {
-class ISerializer;
+
+template<> struct IsBinaryPod<crypto::public_key> : std::true_type {};
+template<> struct IsBinaryPod<crypto::secret_key> : std::true_type {};
+template<> struct IsBinaryPod<crypto::hash> : std::true_type {};
+template<> struct IsBinaryPod<crypto::key_image> : std::true_type {};
+template<> struct IsBinaryPod<crypto::signature> : std::true_type {};
+
 }
 
 namespace crypto {
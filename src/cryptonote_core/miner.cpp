@@ -29,9 +29,15 @@ using namespace epee;
 #include <thread>
 #include <future>
 
+#if defined(_WIN32)
+#include <windows.h>
+#elif !defined(__APPLE__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
 namespace cryptonote
 {
-
   miner::miner(const Currency& currency, i_miner_handler* phandler):
     m_currency(currency),
     m_stop(1),
@@ -42,6 +48,8 @@ namespace cryptonote
     m_phandler(phandler),
     m_pausers_count(0),
     m_threads_total(0),
+    m_ways(0),
+    m_pin_threads(false),
     m_starter_nonce(0),
     m_last_hr_merge_time(0),
     m_hashes(0),
@@ -56,8 +64,15 @@ namespace cryptonote
   }
   //-----------------------------------------------------------------------------------------------------
   bool miner::set_block_template(const Block& bl, const difficulty_type& di) {
+    BlockHashingBlob blob;
+    if (!blob.init(bl)) {
+      LOG_ERROR("Failed to get block hashing blob");
+      return false;
+    }
+
     CRITICAL_REGION_LOCAL(m_template_lock);
     m_template = bl;
+    m_template_blob = blob;
 
     m_diffic = di;
     ++m_template_no;
@@ -88,8 +103,7 @@ namespace cryptonote
       LOG_ERROR("Failed to get_block_template(), stopping mining");
       return false;
     }
-    set_block_template(bl, di);
-    return true;
+    return set_block_template(bl, di);
   }
   //-----------------------------------------------------------------------------------------------------
   bool miner::on_idle()
@@ -154,6 +168,13 @@ namespace cryptonote
       LOG_PRINT_L0("Loaded " << m_extra_messages.size() << " extra messages, current index " << m_config.current_extra_message_index);
     }
 
+    if (config.miningWays != 0 && config.miningWays != 1 && config.miningWays != 2 && config.miningWays != 4) {
+      LOG_ERROR("Mining ways must be 1, 2 or 4, got " << config.miningWays);
+      return false;
+    }
+    m_ways = config.miningWays;
+    m_pin_threads = config.pinMiningThreads;
+
     if(!config.startMining.empty()) {
       if (!m_currency.parseAccountAddressString(config.startMining, m_mine_address)) {
         LOG_ERROR("Target account address " << config.startMining << " has wrong format, starting daemon canceled");
@@ -234,6 +255,10 @@ namespace cryptonote
   }
   //-----------------------------------------------------------------------------------------------------
   bool miner::find_nonce_for_given_block(crypto::cn_context &context, Block& bl, const difficulty_type& diffic) {
+    BlockHashingBlob blob;
+    if (!blob.init(bl)) {
+      return false;
+    }
 
     unsigned nthreads = std::thread::hardware_concurrency();
 
@@ -248,14 +273,11 @@ namespace cryptonote
           crypto::cn_context localctx;
           crypto::hash h;
 
-          Block lb(bl); // copy to local block
+          BlockHashingBlob localBlob(blob); // copy to local blob
 
           for (uint32_t nonce = startNonce + i; !found; nonce += nthreads) {
-            lb.nonce = nonce;
-
-            if (!get_block_longhash(localctx, lb, h)) {
-              return;
-            }
+            localBlob.setNonce(nonce);
+            localBlob.getLongHash(localctx, h);
 
             if (check_hash(h, diffic)) {
               foundNonce = nonce;
@@ -278,9 +300,8 @@ namespace cryptonote
     } else {
       for (; bl.nonce != std::numeric_limits<uint32_t>::max(); bl.nonce++) {
         crypto::hash h;
-        if (!get_block_longhash(context, bl, h)) {
-          return false;
-        }
+        blob.setNonce(bl.nonce);
+        blob.getLongHash(context, h);
 
         if (check_hash(h, diffic)) {
           return true;
@@ -323,6 +344,22 @@ namespace cryptonote
       LOG_PRINT_L2("MINING RESUMED");
   }
   //-----------------------------------------------------------------------------------------------------
+  bool miner::pin_current_thread(uint32_t index)
+  {
+    unsigned cores = std::thread::hardware_concurrency();
+    unsigned core = cores != 0 ? index % cores : 0;
+#if defined(__APPLE__)
+    return false;
+#elif defined(_WIN32)
+    return ::SetThreadAffinityMask(::GetCurrentThread(), DWORD_PTR(1) << core) != 0;
+#else
+    cpu_set_t cpuset;
+    CPU_ZERO(&cpuset);
+    CPU_SET(core, &cpuset);
+    return ::pthread_setaffinity_np(::pthread_self(), sizeof(cpuset), &cpuset) == 0;
+#endif
+  }
+  //-----------------------------------------------------------------------------------------------------
   bool miner::worker_thread()
   {
     uint32_t th_local_index = boost::interprocess::ipcdetail::atomic_inc32(&m_thread_index);
@@ -331,8 +368,19 @@ namespace cryptonote
     uint32_t nonce = m_starter_nonce + th_local_index;
     difficulty_type local_diff = 0;
     uint32_t local_template_ver = 0;
-    crypto::cn_context context;
+    //each way hashes its own copy of the template, with nonces a full round of threads apart
+    size_t ways = m_ways != 0 ? m_ways : crypto::cn_slow_hash_preferred_ways(m_threads_total);
+    if (m_pin_threads && !pin_current_thread(th_local_index)) {
+      LOG_PRINT_L0("Failed to bind miner thread [" << th_local_index << "] to a CPU core");
+    }
+
+    //allocated after pinning: the scratchpads are populated here, on this core's NUMA node
+    crypto::cn_context context(ways);
+    LOG_PRINT_L1("Miner thread [" << th_local_index << "] computes " << ways << " hashes at once, scratchpads use " << context.get_memory_backing_name());
     Block b;
+    std::vector<BlockHashingBlob> blobs(ways);
+    std::vector<const void*> blob_data(ways);
+    std::vector<crypto::hash> hashes(ways);
     while(!m_stop)
     {
       if(m_pausers_count)//anti split workaround
@@ -346,6 +394,7 @@ namespace cryptonote
 
         CRITICAL_REGION_BEGIN(m_template_lock);
         b = m_template;
+        blobs.assign(ways, m_template_blob);
         local_diff = m_diffic;
         CRITICAL_REGION_END();
         local_template_ver = m_template_no;
@@ -359,15 +408,18 @@ namespace cryptonote
         continue;
       }
 
-      b.nonce = nonce;
-      crypto::hash h;
-      if (!m_stop && !get_block_longhash(context, b, h)) {
-        LOG_ERROR("Failed to get block long hash");
-        m_stop = true;
+      for (size_t w = 0; w < ways; ++w) {
+        blobs[w].setNonce(nonce + static_cast<uint32_t>(w) * m_threads_total);
+        blob_data[w] = blobs[w].getBlob().data();
       }
+      crypto::cn_slow_hash_ways(context, blob_data.data(), blobs[0].getBlob().size(), hashes.data());
 
-      if (!m_stop && check_hash(h, local_diff))
-      {
+      for (size_t w = 0; w < ways && !m_stop; ++w) {
+        if (!check_hash(hashes[w], local_diff)) {
+          continue;
+        }
+
+        b.nonce = blobs[w].getNonce();
         //we lucky!
         ++m_config.current_extra_message_index;
         LOG_PRINT_GREEN("Found block for difficulty: " << local_diff, LOG_LEVEL_0);
@@ -379,10 +431,11 @@ namespace cryptonote
           //success update, lets update config
           epee::serialization::store_t_to_json_file(m_config, m_config_folder_path + "/" + cryptonote::parameters::MINER_CONFIG_FILE_NAME);
         }
+        break;
       }
 
-      nonce+=m_threads_total;
-      ++m_hashes;
+      nonce += m_threads_total * static_cast<uint32_t>(ways);
+      m_hashes += ways;
     }
     LOG_PRINT_L0("Miner thread stopped ["<< th_local_index << "]");
     return true;
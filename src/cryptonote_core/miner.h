@@ -13,6 +13,7 @@
 #include "serialization/keyvalue_serialization.h"
 #include "math_helper.h"
 
+#include "cryptonote_core/BlockHashingBlob.h"
 #include "cryptonote_core/cryptonote_basic.h"
 #include "cryptonote_core/Currency.h"
 #include "cryptonote_core/difficulty.h"
@@ -37,6 +38,8 @@ namespace cryptonote {
     void on_synchronized();
     //synchronous analog (for fast calls)
     static bool find_nonce_for_given_block(crypto::cn_context &context, Block& bl, const difficulty_type& diffic);
+    //binds the calling thread to core index modulo the core count
+    static bool pin_current_thread(uint32_t index);
     void pause();
     void resume();
     void do_print_hashrate(bool do_hr);
@@ -60,11 +63,14 @@ namespace cryptonote {
     volatile uint32_t m_stop;
     epee::critical_section m_template_lock;
     Block m_template;
+    BlockHashingBlob m_template_blob;
     std::atomic<uint32_t> m_template_no;
     std::atomic<uint32_t> m_starter_nonce;
     difficulty_type m_diffic;
     volatile uint32_t m_thread_index;
     volatile uint32_t m_threads_total;
+    uint32_t m_ways;
+    bool m_pin_threads;
     std::atomic<int32_t> m_pausers_count;
     epee::critical_section m_miners_count_lock;
 
@@ -118,8 +118,7 @@ namespace cryptonote
       if(!::do_serialize(ar, field))
         return false;
 
-      std::istringstream iss(field);
-      binary_archive<false> iar(iss);
+      memory_binary_archive<false> iar(field);
       serialize_helper helper(*this);
       return ::serialization::serialize(iar, helper);
     }
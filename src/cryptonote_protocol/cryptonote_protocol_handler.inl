@@ -284,11 +284,12 @@ namespace cryptonote
 
     context.m_remote_blockchain_height = arg.current_blockchain_height;
 
-    size_t count = 0;
+    std::vector<Block> blocks;
+    blocks.reserve(arg.blocks.size());
     for (const block_complete_entry& block_entry : arg.blocks)
     {
-      ++count;
-      Block b;
+      blocks.emplace_back();
+      Block& b = blocks.back();
       if(!parse_and_validate_block_from_blob(block_entry.block, b))
       {
         LOG_ERROR_CCONTEXT("sent wrong block: failed to parse and validate block: \r\n" 
@@ -296,10 +297,21 @@ namespace cryptonote
         m_p2p->drop_connection(context);
         return 1;
       }
+    }
+
+    std::vector<crypto::hash> blockHashes;
+    get_block_hashes(blocks, blockHashes);
+
+    size_t count = 0;
+    for (const block_complete_entry& block_entry : arg.blocks)
+    {
+      const Block& b = blocks[count];
+      const crypto::hash& blockHash = blockHashes[count];
+      ++count;
       //to avoid concurrency in core between connections, suspend connections which delivered block later then first one
       if(count == 2)
       { 
-        if(m_core.have_block(get_block_hash(b)))
+        if(m_core.have_block(blockHash))
         {
           context.m_state = cryptonote_connection_context::state_idle;
           context.m_needed_objects.clear();
@@ -309,7 +321,7 @@ namespace cryptonote
         }
       }
 
-      auto req_it = context.m_requested_objects.find(get_block_hash(b));
+      auto req_it = context.m_requested_objects.find(blockHash);
       if(req_it == context.m_requested_objects.end())
       {
         LOG_ERROR_CCONTEXT("sent wrong NOTIFY_RESPONSE_GET_OBJECTS: block with id=" << epee::string_tools::pod_to_hex(get_blob_hash(block_entry.block)) 
@@ -341,6 +353,12 @@ namespace cryptonote
       epee::misc_utils::auto_scope_leave_caller scope_exit_handler = epee::misc_utils::create_scope_leave_handler(
         std::bind(&t_core::update_block_template_and_resume_mining, &m_core));
 
+      //hash the whole batch on all cores, blocks below only check difficulty against the precomputed hashes
+      TIME_MEASURE_START(pow_precompute_time);
+      m_core.precompute_proof_of_work(blocks);
+      TIME_MEASURE_FINISH(pow_precompute_time);
+      LOG_PRINT_CCONTEXT_L2("Proof of work precompute time: " << pow_precompute_time << " ms");
+
       for (const block_complete_entry& block_entry : arg.blocks) {
         if (m_stop) {
           break;
@@ -23,6 +23,7 @@ using namespace epee;
 #include "cryptonote_core/CoreConfig.h"
 #include "cryptonote_core/Currency.h"
 #include "cryptonote_core/MinerConfig.h"
+#include "cryptonote_core/MiningBenchmark.h"
 #include "cryptonote_protocol/cryptonote_protocol_handler.h"
 #include "daemon/daemon_commands_handler.h"
 #include "p2p/net_node.h"
@@ -105,6 +106,7 @@ int main(int argc, char* argv[])
   // tools::get_default_data_dir() can't be called during static initialization
   command_line::add_arg(desc_cmd_only, command_line::arg_data_dir, tools::get_default_data_dir());
   command_line::add_arg(desc_cmd_only, arg_config_file);
+  cryptonote::MiningBenchmarkConfig::initOptions(desc_cmd_only);
 
   command_line::add_arg(desc_cmd_sett, arg_log_file);
   command_line::add_arg(desc_cmd_sett, arg_log_level);
@@ -194,6 +196,22 @@ int main(int argc, char* argv[])
   }
 
   cryptonote::Currency currency = currencyBuilder.currency();
+
+  cryptonote::MiningBenchmarkConfig benchmarkConfig;
+  if (!benchmarkConfig.init(vm)) {
+    return 1;
+  }
+
+  if (benchmarkConfig.enabled) {
+    cryptonote::MiningBenchmark benchmark(currency, benchmarkConfig);
+    if (!benchmark.run()) {
+      return 1;
+    }
+
+    benchmark.print(std::cout);
+    return 0;
+  }
+
   cryptonote::core ccore(currency, NULL);
 
   cryptonote::checkpoints checkpoints;
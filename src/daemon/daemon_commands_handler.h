@@ -31,6 +31,7 @@ public:
     m_cmd_binder.set_handler("print_block", boost::bind(&daemon_cmmands_handler::print_block, this, _1), "Print block, print_block <block_hash> | <block_height>");
     m_cmd_binder.set_handler("print_stat", boost::bind(&daemon_cmmands_handler::print_stat, this, _1), "Print statistics, print_stat <nothing=last> | <block_hash> | <block_height>");
     m_cmd_binder.set_handler("print_tx", boost::bind(&daemon_cmmands_handler::print_tx, this, _1), "Print transaction, print_tx <transaction_hash>");
+    m_cmd_binder.set_handler("print_key_cache", boost::bind(&daemon_cmmands_handler::print_key_cache, this, _1), "Print usage of the output key cache used by ring signature checks");
     m_cmd_binder.set_handler("start_mining", boost::bind(&daemon_cmmands_handler::start_mining, this, _1), "Start mining for specified address, start_mining <addr> [threads=1]");
     m_cmd_binder.set_handler("stop_mining", boost::bind(&daemon_cmmands_handler::stop_mining, this, _1), "Stop mining");
     m_cmd_binder.set_handler("print_pool", boost::bind(&daemon_cmmands_handler::print_pool, this, _1), "Print transaction pool (long format)");
@@ -283,6 +284,19 @@ private:
     return true;
   }
   //--------------------------------------------------------------------------------
+  bool print_key_cache(const std::vector<std::string>& args) {
+    const auto& cache = m_srv.get_payload_object().get_core().get_blockchain_storage().getOutputKeyCache();
+    uint64_t hits = cache.getHits();
+    uint64_t lookups = hits + cache.getMisses();
+    std::cout << "Output key cache: " << cache.size() << " of " << cache.capacity() << " keys" << std::endl;
+    std::cout << "Lookups: " << lookups << ", hits: " << hits;
+    if (lookups != 0) {
+      std::cout << " (" << hits * 100 / lookups << "%)";
+    }
+    std::cout << std::endl;
+    return true;
+  }
+  //--------------------------------------------------------------------------------
   bool print_block(const std::vector<std::string>& args)
   {
     if (args.empty())
@@ -13,6 +13,7 @@
 #include "string_tools.h"
 #include "cryptonote_core/account.h"
 #include "cryptonote_core/cryptonote_format_utils.h"
+#include "cryptonote_core/MiningBenchmark.h"
 
 using namespace epee;
 namespace po = boost::program_options;
@@ -31,14 +32,21 @@ int main(int argc, char** argv)
   po::options_description desc("Allowed options");
   command_line::add_arg(desc, command_line::arg_help);
   mining::simpleminer::init_options(desc);
+  cryptonote::MiningBenchmarkConfig::initOptions(desc);
 
   //uint32_t t = mining::get_target_for_difficulty(700000);
 
   po::variables_map vm;
+  cryptonote::MiningBenchmarkConfig benchmarkConfig;
   bool r = command_line::handle_error_helper(desc, [&]()
   {
     po::store(po::parse_command_line(argc, argv, desc), vm);
-    po::notify(vm);
+    if (!benchmarkConfig.init(vm))
+      return false;
+
+    //the pool options are not needed to benchmark
+    if (!benchmarkConfig.enabled)
+      po::notify(vm);
 
     if (command_line::get_arg(vm, command_line::arg_help))
     {
@@ -51,6 +59,17 @@ int main(int argc, char** argv)
   if (!r)
     return 1;
 
+  if (benchmarkConfig.enabled)
+  {
+    cryptonote::Currency currency = cryptonote::CurrencyBuilder().currency();
+    cryptonote::MiningBenchmark benchmark(currency, benchmarkConfig);
+    if (!benchmark.run())
+      return 1;
+
+    benchmark.print(std::cout);
+    return 0;
+  }
+
   mining::simpleminer miner;
   r = miner.init(vm);
   r = r && miner.run(); // Never returns...
@@ -65,6 +84,7 @@ namespace mining
   const command_line::arg_descriptor<std::string, true> arg_pool_addr = {"pool-addr", ""};
   const command_line::arg_descriptor<std::string, true> arg_login = {"login", ""};
   const command_line::arg_descriptor<std::string, true> arg_pass = {"pass", ""};
+  const command_line::arg_descriptor<uint32_t> arg_ways = {"ways", "Hashes computed at once (1, 2 or 4), 0 to choose from the CPU", 0};
 
   //-----------------------------------------------------------------------------------------------------
   void simpleminer::init_options(boost::program_options::options_description& desc)
@@ -72,6 +92,7 @@ namespace mining
     command_line::add_arg(desc, arg_pool_addr);
     command_line::add_arg(desc, arg_login);
     command_line::add_arg(desc, arg_pass);
+    command_line::add_arg(desc, arg_ways);
   }
   bool simpleminer::init(const boost::program_options::variables_map& vm)
   {
@@ -83,12 +104,19 @@ namespace mining
     m_pool_port = pool_addr.substr(p + 1, pool_addr.size());
     m_login = command_line::get_arg(vm, arg_login);
     m_pass = command_line::get_arg(vm, arg_pass);
+    m_ways = command_line::get_arg(vm, arg_ways);
+    CHECK_AND_ASSERT_MES(m_ways == 0 || m_ways == 1 || m_ways == 2 || m_ways == 4, false, "Wrong ways count, must be 1, 2 or 4");
+    if (m_ways == 0)
+      m_ways = static_cast<uint32_t>(crypto::cn_slow_hash_preferred_ways(1));
     return true;
   }
 
   bool simpleminer::text_job_details_to_native_job_details(const job_details& job, simpleminer::job_details_native& native_details)
   {
-    bool r = epee::string_tools::parse_hexstr_to_binbuff(job.blob, native_details.blob);
+    cryptonote::blobdata blob;
+    bool r = epee::string_tools::parse_hexstr_to_binbuff(job.blob, blob);
+    CHECK_AND_ASSERT_MES(r, false, "wrong buffer sent from pool server");
+    r = native_details.blob.init(blob);
     CHECK_AND_ASSERT_MES(r, false, "wrong buffer sent from pool server");
     r = epee::string_tools::parse_tpod_from_hex_string(job.target, native_details.target);
     CHECK_AND_ASSERT_MES(r, false, "wrong buffer sent from pool server");
@@ -101,7 +129,10 @@ namespace mining
     std::string pool_session_id;
     simpleminer::job_details_native job = AUTO_VAL_INIT(job);
     uint64_t last_job_ticks = 0;
-    crypto::cn_context context;
+    crypto::cn_context context(m_ways);
+    std::vector<cryptonote::BlockHashingBlob> lanes;
+    std::vector<const void*> lane_data(m_ways);
+    std::vector<crypto::hash> hashes(m_ways);
 
     while(true)
     {
@@ -154,21 +185,35 @@ namespace mining
         last_job_ticks = epee::misc_utils::get_tick_count();
 
       }
+      lanes.assign(m_ways, job.blob);
       while(epee::misc_utils::get_tick_count() - last_job_ticks < 20000)
       {
-        //uint32_t c = (*((uint32_t*)&job.blob.data()[39]));
-        ++(*((uint32_t*)&job.blob.data()[39]));
-        crypto::hash h = cryptonote::null_hash;
-        crypto::cn_slow_hash(context, job.blob.data(), job.blob.size(), h);
-        if(  ((uint32_t*)&h)[7] < job.target )
+        uint32_t nonce = job.blob.getNonce();
+        for (size_t w = 0; w != m_ways; ++w)
+        {
+          lanes[w].setNonce(nonce + 1 + static_cast<uint32_t>(w));
+          lane_data[w] = lanes[w].getBlob().data();
+        }
+        job.blob.setNonce(nonce + m_ways);
+        crypto::cn_slow_hash_ways(context, lane_data.data(), job.blob.getBlob().size(), hashes.data());
+
+        size_t found = m_ways;
+        for (size_t w = 0; w != m_ways && found == m_ways; ++w)
+        {
+          if (((uint32_t*)&hashes[w])[7] < job.target)
+            found = w;
+        }
+
+        if (found != m_ways)
         {
           //found!
+          const crypto::hash& h = hashes[found];
 
           COMMAND_RPC_SUBMITSHARE::request submit_request = AUTO_VAL_INIT(submit_request);
           COMMAND_RPC_SUBMITSHARE::response submit_response = AUTO_VAL_INIT(submit_response);
           submit_request.id     = pool_session_id;
           submit_request.job_id = job.job_id;
-          submit_request.nonce  = epee::string_tools::pod_to_hex((*((uint32_t*)&job.blob.data()[39])));
+          submit_request.nonce  = epee::string_tools::pod_to_hex(lanes[found].getNonce());
           submit_request.result = epee::string_tools::pod_to_hex(h);
           LOG_PRINT_L0("Share found: nonce=" << submit_request.nonce << " for job=" << job.job_id << ", submitting...");
           if(!epee::net_utils::invoke_http_json_rpc<mining::COMMAND_RPC_SUBMITSHARE>("/", submit_request, submit_response, m_http_client))
@@ -5,6 +5,7 @@
 
 #pragma once 
 #include "net/http_client.h"
+#include "cryptonote_core/BlockHashingBlob.h"
 #include "cryptonote_protocol/blobdatatype.h"
 #include "simpleminer_protocol_defs.h"
 namespace mining
@@ -18,7 +19,7 @@ namespace mining
   private: 
     struct job_details_native
     {
-      cryptonote::blobdata blob;
+      cryptonote::BlockHashingBlob blob;
       uint32_t target;
       std::string job_id;
     };
@@ -29,6 +30,7 @@ namespace mining
     std::string m_pool_port;
     std::string m_login;
     std::string m_pass;
+    uint32_t m_ways;
     epee::net_utils::http::http_simple_client m_http_client;
   };
 }
@@ -129,6 +129,11 @@ ISerializer& BinaryInputStreamSerializer::binary(std::string& value, const std::
   return (*this)(value, name);
 }
 
+ISerializer& BinaryInputStreamSerializer::binaryItems(void* value, std::size_t itemSize, std::size_t count) {
+  checkedRead(static_cast<char*>(value), itemSize * count);
+  return *this;
+}
+
 
 bool BinaryInputStreamSerializer::hasObject(const std::string& name) {
   assert(false); //the method is not supported for this type of serialization
@@ -37,6 +37,7 @@ public:
 
   virtual ISerializer& binary(void* value, std::size_t size, const std::string& name) override;
   virtual ISerializer& binary(std::string& value, const std::string& name) override;
+  virtual ISerializer& binaryItems(void* value, std::size_t itemSize, std::size_t count) override;
 
   virtual bool hasObject(const std::string& name) override;
 
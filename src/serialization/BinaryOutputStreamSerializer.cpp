@@ -96,6 +96,11 @@ ISerializer& BinaryOutputStreamSerializer::binary(std::string& value, const std:
   return (*this)(value, name);
 }
 
+ISerializer& BinaryOutputStreamSerializer::binaryItems(void* value, std::size_t itemSize, std::size_t count) {
+  checkedWrite(static_cast<const char*>(value), itemSize * count);
+  return *this;
+}
+
 bool BinaryOutputStreamSerializer::hasObject(const std::string& name) {
   assert(false); //the method is not supported for this type of serialization
   throw std::runtime_error("hasObject method is not supported in BinaryOutputStreamSerializer");
@@ -39,6 +39,8 @@ public:
   // read/write binary block
   virtual ISerializer& binary(void* value, std::size_t size, const std::string& name) = 0;
   virtual ISerializer& binary(std::string& value, const std::string& name) = 0;
+  // read/write count binary blocks of itemSize bytes stored back to back, e.g. an array of hashes
+  virtual ISerializer& binaryItems(void* value, std::size_t itemSize, std::size_t count);
 
   virtual bool hasObject(const std::string& name) = 0;
 
@@ -46,6 +48,14 @@ public:
   ISerializer& operator()(T& value, const std::string& name);
 };
 
+inline ISerializer& ISerializer::binaryItems(void* value, std::size_t itemSize, std::size_t count) {
+  for (std::size_t i = 0; i < count; ++i) {
+    binary(static_cast<uint8_t*>(value) + i * itemSize, itemSize, "");
+  }
+
+  return *this;
+}
+
 template<typename T>
 ISerializer& ISerializer::operator()(T& value, const std::string& name) {
   serialize(value, name, *this);
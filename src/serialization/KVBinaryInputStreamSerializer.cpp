@@ -6,8 +6,6 @@
 #include "KVBinaryInputStreamSerializer.h"
 #include "KVBinaryCommon.h"
 
-#include "JsonValue.h"
-
 #include <algorithm>
 #include <cassert>
 #include <stdexcept>
@@ -18,109 +16,205 @@ using namespace cryptonote;
 
 namespace {
 
+const std::size_t READ_CHUNK_SIZE = 64 * 1024;
+
 template <typename T>
-T readPod(std::istream& s) {
+T readPod(const uint8_t* data) {
   T v;
-  s.read(reinterpret_cast<char*>(&v), sizeof(T));
+  memcpy(&v, data, sizeof(T));
   return v;
 }
 
-template <typename T, typename JsonT = T>
-cryptonote::JsonValue readPodJson(std::istream& s) {
-  T v;
-  s.read(reinterpret_cast<char*>(&v), sizeof(T));
-  cryptonote::JsonValue jv;
-  jv = static_cast<JsonT>(v);
-  return jv;
+//size of fixed-size values, 0 for strings, sections and nested arrays
+std::size_t podSize(uint8_t type) {
+  switch (type) {
+  case BIN_KV_SERIALIZE_TYPE_INT64:
+  case BIN_KV_SERIALIZE_TYPE_UINT64:
+  case BIN_KV_SERIALIZE_TYPE_DOUBLE:
+    return 8;
+  case BIN_KV_SERIALIZE_TYPE_INT32:
+  case BIN_KV_SERIALIZE_TYPE_UINT32:
+    return 4;
+  case BIN_KV_SERIALIZE_TYPE_INT16:
+  case BIN_KV_SERIALIZE_TYPE_UINT16:
+    return 2;
+  case BIN_KV_SERIALIZE_TYPE_INT8:
+  case BIN_KV_SERIALIZE_TYPE_UINT8:
+  case BIN_KV_SERIALIZE_TYPE_BOOL:
+    return 1;
+  default:
+    return 0;
+  }
 }
 
-template <typename T>
-cryptonote::JsonValue readIntegerJson(std::istream& s) {
-  return readPodJson<T, int64_t>(s);
 }
 
-size_t readVarint(std::istream& s) {
-  size_t v = 0;
-  uint8_t size_mask = uint8_t(s.peek()) & PORTABLE_RAW_SIZE_MARK_MASK;
+namespace cryptonote {
 
-  switch (size_mask) {
-  case PORTABLE_RAW_SIZE_MARK_BYTE:
-    v = readPod<uint8_t>(s);
-    break;
-  case PORTABLE_RAW_SIZE_MARK_WORD:
-    v = readPod<uint16_t>(s);
-    break;
-  case PORTABLE_RAW_SIZE_MARK_DWORD:
-    v = readPod<uint32_t>(s);
-    break;
-  case PORTABLE_RAW_SIZE_MARK_INT64:
-    v = readPod<uint64_t>(s);
-    break;
-  default:
-    throw std::runtime_error("unknown varint size_mask");
+KVBinaryInputStreamSerializer::KVBinaryInputStreamSerializer(std::istream& strm) : stream(strm) {
+}
+
+void KVBinaryInputStreamSerializer::parse() {
+  buffer.clear();
+  entries.clear();
+  chain.clear();
+
+  while (stream) {
+    std::size_t size = buffer.size();
+    buffer.resize(size + READ_CHUNK_SIZE);
+    stream.read(reinterpret_cast<char*>(&buffer[size]), READ_CHUNK_SIZE);
+    buffer.resize(size + static_cast<std::size_t>(stream.gcount()));
   }
 
-  v >>= 2;
-  return v;
+  auto hdr = readPod<KVBinaryStorageBlockHeader>(data(0, sizeof(KVBinaryStorageBlockHeader)));
+
+  if (
+    hdr.m_signature_a != PORTABLE_STORAGE_SIGNATUREA ||
+    hdr.m_signature_b != PORTABLE_STORAGE_SIGNATUREB) {
+    throw std::runtime_error("Invalid binary storage signature");
+  }
+
+  if (hdr.m_ver != PORTABLE_STORAGE_FORMAT_VER) {
+    throw std::runtime_error("Unknown binary storage format version");
+  }
 }
 
-std::string readString(std::istream& s) {
-  auto size = readVarint(s);
-  std::string str;
-  str.resize(size);
-  s.read(&str[0], size);
-  return str;
+ISerializer::SerializerType KVBinaryInputStreamSerializer::type() const {
+  return ISerializer::INPUT;
 }
 
-JsonValue readStringJson(std::istream& s) {
-  JsonValue js;
-  js = readString(s);
-  return js;
+ISerializer& KVBinaryInputStreamSerializer::beginObject(const std::string& name) {
+  if (chain.empty()) {
+    indexSection(sizeof(KVBinaryStorageBlockHeader));
+    return *this;
+  }
+
+  if (chain.back().isArray) {
+    Scope& parent = chain.back();
+    if (parent.index >= parent.count || parent.itemType != BIN_KV_SERIALIZE_TYPE_OBJECT) {
+      throw std::runtime_error("KVBinaryInputStreamSerializer: array item is not an object");
+    }
+
+    ++parent.index;
+    std::size_t end = indexSection(parent.offset);
+    chain[chain.size() - 2].offset = end;
+    return *this;
+  }
+
+  const Entry* entry = findEntry(name);
+  if (entry == nullptr || entry->type != BIN_KV_SERIALIZE_TYPE_OBJECT) {
+    throw std::runtime_error("KVBinaryInputStreamSerializer: object not found: " + name);
+  }
+
+  indexSection(entry->valueOffset);
+  return *this;
 }
 
-void readName(std::istream& s, std::string& name) {
-  uint8_t len = readPod<uint8_t>(s);
-  name.resize(len);
-  s.read(&name[0], len);
+ISerializer& KVBinaryInputStreamSerializer::endObject() {
+  assert(!chain.empty() && !chain.back().isArray);
+  entries.resize(chain.back().firstEntry);
+  chain.pop_back();
+  return *this;
 }
 
+ISerializer& KVBinaryInputStreamSerializer::beginArray(std::size_t& size, const std::string& name) {
+  const Entry* entry = findEntry(name);
+  Scope scope = { true, 0, 0, 0, 0, entries.size() };
+
+  if (entry != nullptr) {
+    if ((entry->type & BIN_KV_SERIALIZE_FLAG_ARRAY) == 0) {
+      throw std::runtime_error("KVBinaryInputStreamSerializer: value is not an array: " + name);
+    }
+
+    scope.itemType = entry->type & ~BIN_KV_SERIALIZE_FLAG_ARRAY;
+    scope.offset = entry->valueOffset;
+    scope.count = readVarint(scope.offset);
+  }
+
+  size = scope.count;
+  chain.push_back(scope);
+  return *this;
 }
 
+ISerializer& KVBinaryInputStreamSerializer::endArray() {
+  assert(!chain.empty() && chain.back().isArray);
+  chain.pop_back();
+  return *this;
+}
 
-namespace cryptonote {
+ISerializer& KVBinaryInputStreamSerializer::operator()(uint8_t& value, const std::string& name) {
+  value = static_cast<uint8_t>(readInteger(name));
+  return *this;
+}
 
-void KVBinaryInputStreamSerializer::parse() {
-  auto hdr = readPod<KVBinaryStorageBlockHeader>(stream);
+ISerializer& KVBinaryInputStreamSerializer::operator()(int32_t& value, const std::string& name) {
+  value = static_cast<int32_t>(readInteger(name));
+  return *this;
+}
 
-  if (
-    hdr.m_signature_a != PORTABLE_STORAGE_SIGNATUREA ||
-    hdr.m_signature_b != PORTABLE_STORAGE_SIGNATUREB) {
-    throw std::runtime_error("Invalid binary storage signature");
+ISerializer& KVBinaryInputStreamSerializer::operator()(uint32_t& value, const std::string& name) {
+  value = static_cast<uint32_t>(readInteger(name));
+  return *this;
+}
+
+ISerializer& KVBinaryInputStreamSerializer::operator()(int64_t& value, const std::string& name) {
+  value = readInteger(name);
+  return *this;
+}
+
+ISerializer& KVBinaryInputStreamSerializer::operator()(uint64_t& value, const std::string& name) {
+  value = static_cast<uint64_t>(readInteger(name));
+  return *this;
+}
+
+ISerializer& KVBinaryInputStreamSerializer::operator()(double& value, const std::string& name) {
+  uint8_t type;
+  std::size_t offset = nextValue(name, type);
+  if (type != BIN_KV_SERIALIZE_TYPE_DOUBLE) {
+    throw std::runtime_error("KVBinaryInputStreamSerializer: value is not a double: " + name);
   }
 
-  if (hdr.m_ver != PORTABLE_STORAGE_FORMAT_VER) {
-    throw std::runtime_error("Unknown binary storage format version");
+  value = readPod<double>(data(offset, sizeof(double)));
+  return *this;
+}
+
+ISerializer& KVBinaryInputStreamSerializer::operator()(bool& value, const std::string& name) {
+  uint8_t type;
+  std::size_t offset = nextValue(name, type);
+  if (type != BIN_KV_SERIALIZE_TYPE_BOOL) {
+    throw std::runtime_error("KVBinaryInputStreamSerializer: value is not a bool: " + name);
   }
 
-  root.reset(new JsonValue(loadSection()));
-  setJsonValue(root.get());
+  value = *data(offset, 1) != 0;
+  return *this;
 }
 
-ISerializer& KVBinaryInputStreamSerializer::binary(void* value, std::size_t size, const std::string& name) {
-  std::string str;
+ISerializer& KVBinaryInputStreamSerializer::operator()(std::string& value, const std::string& name) {
+  const uint8_t* str;
+  std::size_t size;
+  readString(name, str, size);
+  value.assign(reinterpret_cast<const char*>(str), size);
+  return *this;
+}
 
-  (*this)(str, name);
+ISerializer& KVBinaryInputStreamSerializer::binary(void* value, std::size_t size, const std::string& name) {
+  const uint8_t* blob;
+  std::size_t blobSize;
+  readString(name, blob, blobSize);
 
-  if (str.size() != size) {
+  if (blobSize != size) {
     throw std::runtime_error("Binary block size mismatch");
   }
 
-  memcpy(value, str.data(), size);
+  if (size != 0) {
+    memcpy(value, blob, size);
+  }
+
   return *this;
 }
 
 ISerializer& KVBinaryInputStreamSerializer::binary(std::string& value, const std::string& name) {
-  if (!hasObject(name)) {
+  if (!chain.back().isArray && !hasObject(name)) {
     value.clear();
     return *this;
   }
@@ -128,61 +222,199 @@ ISerializer& KVBinaryInputStreamSerializer::binary(std::string& value, const std
   return (*this)(value, name); // load as string
 }
 
-JsonValue KVBinaryInputStreamSerializer::loadSection() {
-  JsonValue sec(JsonValue::OBJECT);
-  size_t count = readVarint(stream);
-  std::string name;
+bool KVBinaryInputStreamSerializer::hasObject(const std::string& name) {
+  return findEntry(name) != nullptr;
+}
 
-  while (count--) {
-    readName(stream, name);
-    sec.insert(name, loadEntry());
+const uint8_t* KVBinaryInputStreamSerializer::data(std::size_t offset, std::size_t size) const {
+  if (offset > buffer.size() || size > buffer.size() - offset) {
+    throw std::runtime_error("KVBinaryInputStreamSerializer: unexpected end of data");
   }
 
-  return sec;
+  return buffer.data() + offset;
 }
 
-JsonValue KVBinaryInputStreamSerializer::loadValue(uint8_t type) {
-  switch (type) {
-  case BIN_KV_SERIALIZE_TYPE_INT64:  return readIntegerJson<int64_t>(stream);
-  case BIN_KV_SERIALIZE_TYPE_INT32:  return readIntegerJson<int32_t>(stream);
-  case BIN_KV_SERIALIZE_TYPE_INT16:  return readIntegerJson<int16_t>(stream);
-  case BIN_KV_SERIALIZE_TYPE_INT8:   return readIntegerJson<int8_t>(stream);
-  case BIN_KV_SERIALIZE_TYPE_UINT64: return readIntegerJson<uint64_t>(stream);
-  case BIN_KV_SERIALIZE_TYPE_UINT32: return readIntegerJson<uint32_t>(stream);
-  case BIN_KV_SERIALIZE_TYPE_UINT16: return readIntegerJson<uint16_t>(stream);
-  case BIN_KV_SERIALIZE_TYPE_UINT8:  return readIntegerJson<uint8_t>(stream);
-  case BIN_KV_SERIALIZE_TYPE_DOUBLE: return readPodJson<double>(stream);
-  case BIN_KV_SERIALIZE_TYPE_BOOL:   return readPodJson<uint8_t, bool>(stream);
-  case BIN_KV_SERIALIZE_TYPE_STRING: return readStringJson(stream);
-  case BIN_KV_SERIALIZE_TYPE_OBJECT: return loadSection();
-  case BIN_KV_SERIALIZE_TYPE_ARRAY:  return loadArray(type);
+std::size_t KVBinaryInputStreamSerializer::readVarint(std::size_t& offset) const {
+  uint64_t v;
+  uint8_t sizeMask = *data(offset, 1) & PORTABLE_RAW_SIZE_MARK_MASK;
+
+  switch (sizeMask) {
+  case PORTABLE_RAW_SIZE_MARK_BYTE:
+    v = readPod<uint8_t>(data(offset, 1));
+    offset += 1;
+    break;
+  case PORTABLE_RAW_SIZE_MARK_WORD:
+    v = readPod<uint16_t>(data(offset, 2));
+    offset += 2;
+    break;
+  case PORTABLE_RAW_SIZE_MARK_DWORD:
+    v = readPod<uint32_t>(data(offset, 4));
+    offset += 4;
+    break;
   default:
-    throw std::runtime_error("Unknown data type");
+    v = readPod<uint64_t>(data(offset, 8));
+    offset += 8;
     break;
   }
+
+  return static_cast<std::size_t>(v >> 2);
 }
 
-JsonValue KVBinaryInputStreamSerializer::loadEntry() {
-  uint8_t type = readPod<uint8_t>(stream);
+std::size_t KVBinaryInputStreamSerializer::skipValue(uint8_t type, std::size_t offset) const {
+  std::size_t size = podSize(type);
+  if (size != 0) {
+    data(offset, size);
+    return offset + size;
+  }
+
+  switch (type) {
+  case BIN_KV_SERIALIZE_TYPE_STRING:
+    size = readVarint(offset);
+    data(offset, size);
+    return offset + size;
+
+  case BIN_KV_SERIALIZE_TYPE_OBJECT: {
+    std::size_t count = readVarint(offset);
+    while (count--) {
+      offset += 1 + *data(offset, 1);
+      uint8_t entryType = *data(offset, 1);
+      offset = skipEntry(entryType, offset + 1);
+    }
+
+    return offset;
+  }
+
+  case BIN_KV_SERIALIZE_TYPE_ARRAY: {
+    uint8_t itemType = *data(offset, 1);
+    if ((itemType & BIN_KV_SERIALIZE_FLAG_ARRAY) == 0) {
+      throw std::runtime_error("Unknown data type");
+    }
 
-  if (type & BIN_KV_SERIALIZE_FLAG_ARRAY) {
-    type &= ~BIN_KV_SERIALIZE_FLAG_ARRAY;
-    return loadArray(type);
+    return skipEntry(itemType, offset + 1);
   }
 
-  return loadValue(type);
+  default:
+    throw std::runtime_error("Unknown data type");
+  }
 }
 
-JsonValue KVBinaryInputStreamSerializer::loadArray(uint8_t itemType) {
-  JsonValue arr(JsonValue::ARRAY);
-  size_t count = readVarint(stream);
+std::size_t KVBinaryInputStreamSerializer::skipEntry(uint8_t type, std::size_t offset) const {
+  if ((type & BIN_KV_SERIALIZE_FLAG_ARRAY) == 0) {
+    return skipValue(type, offset);
+  }
+
+  type &= ~BIN_KV_SERIALIZE_FLAG_ARRAY;
+  std::size_t count = readVarint(offset);
+  std::size_t size = podSize(type);
+  if (size != 0) {
+    //fixed-size items are skipped in one step
+    if (count > (buffer.size() - offset) / size) {
+      throw std::runtime_error("KVBinaryInputStreamSerializer: unexpected end of data");
+    }
+
+    return offset + count * size;
+  }
 
   while (count--) {
-    arr.pushBack(loadValue(itemType));
+    offset = skipValue(type, offset);
+  }
+
+  return offset;
+}
+
+std::size_t KVBinaryInputStreamSerializer::indexSection(std::size_t offset) {
+  Scope scope = { false, 0, 0, 0, readVarint(offset), entries.size() };
+
+  for (std::size_t i = 0; i < scope.count; ++i) {
+    Entry entry;
+    entry.nameSize = *data(offset, 1);
+    entry.nameOffset = offset + 1;
+    offset = entry.nameOffset + entry.nameSize;
+    entry.type = *data(offset, 1);
+    entry.valueOffset = offset + 1;
+    offset = skipEntry(entry.type, entry.valueOffset);
+    entries.push_back(entry);
+  }
+
+  chain.push_back(scope);
+  return offset;
+}
+
+const KVBinaryInputStreamSerializer::Entry* KVBinaryInputStreamSerializer::findEntry(const std::string& name) {
+  assert(!chain.empty());
+  Scope& scope = chain.back();
+  if (scope.isArray) {
+    throw std::runtime_error("KVBinaryInputStreamSerializer: named value requested inside an array: " + name);
+  }
+
+  //fields are usually requested in storage order, so the search starts right after the last hit
+  for (std::size_t i = 0; i < scope.count; ++i) {
+    std::size_t index = (scope.index + i) % scope.count;
+    const Entry& entry = entries[scope.firstEntry + index];
+    if (entry.nameSize == name.size() && memcmp(&buffer[entry.nameOffset], name.data(), name.size()) == 0) {
+      scope.index = index + 1;
+      return &entry;
+    }
+  }
+
+  return nullptr;
+}
+
+std::size_t KVBinaryInputStreamSerializer::nextValue(const std::string& name, uint8_t& type) {
+  assert(!chain.empty());
+  Scope& scope = chain.back();
+  if (scope.isArray) {
+    if (scope.index >= scope.count) {
+      throw std::runtime_error("KVBinaryInputStreamSerializer: array index out of range");
+    }
+
+    std::size_t offset = scope.offset;
+    type = scope.itemType;
+    scope.offset = skipValue(type, offset);
+    ++scope.index;
+    return offset;
+  }
+
+  const Entry* entry = findEntry(name);
+  if (entry == nullptr) {
+    throw std::runtime_error("KVBinaryInputStreamSerializer: value not found: " + name);
+  }
+
+  if ((entry->type & BIN_KV_SERIALIZE_FLAG_ARRAY) != 0) {
+    throw std::runtime_error("KVBinaryInputStreamSerializer: value is an array: " + name);
   }
 
-  return arr;
+  type = entry->type;
+  return entry->valueOffset;
+}
+
+int64_t KVBinaryInputStreamSerializer::readInteger(const std::string& name) {
+  uint8_t type;
+  std::size_t offset = nextValue(name, type);
+
+  switch (type) {
+  case BIN_KV_SERIALIZE_TYPE_INT64:  return readPod<int64_t>(data(offset, 8));
+  case BIN_KV_SERIALIZE_TYPE_INT32:  return readPod<int32_t>(data(offset, 4));
+  case BIN_KV_SERIALIZE_TYPE_INT16:  return readPod<int16_t>(data(offset, 2));
+  case BIN_KV_SERIALIZE_TYPE_INT8:   return readPod<int8_t>(data(offset, 1));
+  case BIN_KV_SERIALIZE_TYPE_UINT64: return static_cast<int64_t>(readPod<uint64_t>(data(offset, 8)));
+  case BIN_KV_SERIALIZE_TYPE_UINT32: return readPod<uint32_t>(data(offset, 4));
+  case BIN_KV_SERIALIZE_TYPE_UINT16: return readPod<uint16_t>(data(offset, 2));
+  case BIN_KV_SERIALIZE_TYPE_UINT8:  return readPod<uint8_t>(data(offset, 1));
+  default:
+    throw std::runtime_error("KVBinaryInputStreamSerializer: value is not an integer: " + name);
+  }
 }
 
+void KVBinaryInputStreamSerializer::readString(const std::string& name, const uint8_t*& value, std::size_t& size) {
+  uint8_t type;
+  std::size_t offset = nextValue(name, type);
+  if (type != BIN_KV_SERIALIZE_TYPE_STRING) {
+    throw std::runtime_error("KVBinaryInputStreamSerializer: value is not a string: " + name);
+  }
+
+  size = readVarint(offset);
+  value = data(offset, size);
+}
 
 }
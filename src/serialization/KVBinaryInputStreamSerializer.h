@@ -8,33 +8,82 @@
 #include "ISerializer.h"
 #include "SerializationOverloads.h"
 
-#include "JsonValue.h"
-#include "JsonInputValueSerializer.h"
-
 #include <istream>
-#include <memory>
+#include <string>
+#include <vector>
 
 namespace cryptonote {
 
-class KVBinaryInputStreamSerializer : public JsonInputValueSerializer {
+// Pull parser over the raw portable storage payload: values are decoded straight from the
+// byte buffer on request, sections are only indexed (name -> offset) when they are entered.
+class KVBinaryInputStreamSerializer : public ISerializer {
 public:
-  KVBinaryInputStreamSerializer(std::istream& strm) : stream(strm) {}
+  KVBinaryInputStreamSerializer(std::istream& strm);
   virtual ~KVBinaryInputStreamSerializer() {}
 
+  // Reads the rest of the stream and checks the storage header
   void parse();
 
+  virtual SerializerType type() const override;
+
+  virtual ISerializer& beginObject(const std::string& name) override;
+  virtual ISerializer& endObject() override;
+
+  virtual ISerializer& beginArray(std::size_t& size, const std::string& name) override;
+  virtual ISerializer& endArray() override;
+
+  virtual ISerializer& operator()(uint8_t& value, const std::string& name) override;
+  virtual ISerializer& operator()(int32_t& value, const std::string& name) override;
+  virtual ISerializer& operator()(uint32_t& value, const std::string& name) override;
+  virtual ISerializer& operator()(int64_t& value, const std::string& name) override;
+  virtual ISerializer& operator()(uint64_t& value, const std::string& name) override;
+  virtual ISerializer& operator()(double& value, const std::string& name) override;
+  virtual ISerializer& operator()(bool& value, const std::string& name) override;
+  virtual ISerializer& operator()(std::string& value, const std::string& name) override;
+
   virtual ISerializer& binary(void* value, std::size_t size, const std::string& name) override;
   virtual ISerializer& binary(std::string& value, const std::string& name) override;
 
+  virtual bool hasObject(const std::string& name) override;
+
+  template<typename T>
+  ISerializer& operator()(T& value, const std::string& name) {
+    return ISerializer::operator()(value, name);
+  }
+
 private:
+  struct Entry {
+    std::size_t nameOffset;
+    std::size_t valueOffset;
+    uint8_t nameSize;
+    uint8_t type;
+  };
+
+  struct Scope {
+    bool isArray;
+    uint8_t itemType;
+    //array: next item offset and position; object: range of its entries in the index
+    std::size_t offset;
+    std::size_t index;
+    std::size_t count;
+    std::size_t firstEntry;
+  };
+
+  const uint8_t* data(std::size_t offset, std::size_t size) const;
+  std::size_t readVarint(std::size_t& offset) const;
+  std::size_t skipValue(uint8_t type, std::size_t offset) const;
+  std::size_t skipEntry(uint8_t type, std::size_t offset) const;
+  std::size_t indexSection(std::size_t offset);
 
-  JsonValue loadSection();
-  JsonValue loadEntry();
-  JsonValue loadValue(uint8_t type);
-  JsonValue loadArray(uint8_t itemType);
+  const Entry* findEntry(const std::string& name);
+  std::size_t nextValue(const std::string& name, uint8_t& type);
+  int64_t readInteger(const std::string& name);
+  void readString(const std::string& name, const uint8_t*& value, std::size_t& size);
 
-  std::unique_ptr<JsonValue> root;
   std::istream& stream;
+  std::vector<uint8_t> buffer;
+  std::vector<Entry> entries;
+  std::vector<Scope> chain;
 };
 
 }
@@ -12,6 +12,7 @@
 #include <unordered_map>
 #include <array>
 #include <cstring>
+#include <type_traits>
 
 namespace cryptonote {
 
@@ -33,16 +34,31 @@ serializeAsBinary(std::vector<T>& value, const std::string& name, cryptonote::IS
   }
 }
 
+// Fixed-size types serialized as a single binary() block; vectors of them are handed
+// to the serializer in one binaryItems() call instead of element by element
 template<typename T>
-void serialize(std::vector<T>& value, const std::string& name, cryptonote::ISerializer& serializer) {
-  std::size_t size = value.size();
-  serializer.beginArray(size, name);
-  value.resize(size);
+struct IsBinaryPod : std::false_type {};
 
-  for (size_t i = 0; i < size; ++i) {
+template<typename T>
+void serializeItems(std::vector<T>& value, cryptonote::ISerializer& serializer, std::false_type) {
+  for (size_t i = 0; i < value.size(); ++i) {
     serializer(value[i], "");
   }
+}
 
+template<typename T>
+void serializeItems(std::vector<T>& value, cryptonote::ISerializer& serializer, std::true_type) {
+  if (!value.empty()) {
+    serializer.binaryItems(value.data(), sizeof(T), value.size());
+  }
+}
+
+template<typename T>
+void serialize(std::vector<T>& value, const std::string& name, cryptonote::ISerializer& serializer) {
+  std::size_t size = value.size();
+  serializer.beginArray(size, name);
+  value.resize(size);
+  serializeItems(value, serializer, typename IsBinaryPod<T>::type());
   serializer.endArray();
 }
 
@@ -9,8 +9,11 @@
 #pragma once
 
 #include <cassert>
+#include <cstring>
 #include <iostream>
 #include <iterator>
+#include <limits>
+#include <string>
 #include <boost/type_traits/make_unsigned.hpp>
 
 #include "common/varint.h"
@@ -167,4 +170,158 @@ struct binary_archive<true> : public binary_archive_base<std::ostream, true>
   }
 };
 
+/* Input stream over a contiguous memory block. Keeps the iostate bits the serialization
+ * code inspects, without virtual calls or an intermediate copy of the data */
+class memory_istream
+{
+public:
+  memory_istream(const void *data, size_t size) :
+    cur_(static_cast<const uint8_t *>(data)), end_(cur_ + size), state_(std::ios_base::goodbit) { }
+
+  bool good() const { return state_ == std::ios_base::goodbit; }
+  std::ios_base::iostate rdstate() const { return state_; }
+  void setstate(std::ios_base::iostate state) { state_ |= state; }
+  void clear(std::ios_base::iostate state = std::ios_base::goodbit) { state_ = state; }
+  size_t remaining() const { return end_ - cur_; }
+
+  int peek()
+  {
+    if (!good() || cur_ == end_) {
+      setstate(std::ios_base::eofbit);
+      return EOF;
+    }
+    return *cur_;
+  }
+
+  bool get(uint8_t &c)
+  {
+    if (!good() || cur_ == end_) {
+      setstate(std::ios_base::failbit | std::ios_base::eofbit);
+      return false;
+    }
+    c = *cur_++;
+    return true;
+  }
+
+  bool read(void *buf, size_t len)
+  {
+    if (!good() || len > remaining()) {
+      cur_ = end_;
+      setstate(std::ios_base::failbit | std::ios_base::eofbit);
+      return false;
+    }
+    if (len != 0)
+      memcpy(buf, cur_, len);
+    cur_ += len;
+    return true;
+  }
+
+private:
+  const uint8_t *cur_;
+  const uint8_t *end_;
+  std::ios_base::iostate state_;
+};
+
+/* Reads the same format as binary_archive<false> straight from a blob that is already in memory */
+template <bool W>
+struct memory_binary_archive;
+
+template <>
+struct memory_binary_archive<false>
+{
+  typedef memory_istream stream_type;
+  typedef boost::mpl::bool_<false> is_saving;
+
+  typedef uint8_t variant_tag_type;
+
+  memory_binary_archive(const void *data, size_t size) : stream_(data, size) { }
+  explicit memory_binary_archive(const std::string &blob) : stream_(blob.data(), blob.size()) { }
+
+  void tag(const char *) { }
+  void begin_object() { }
+  void end_object() { }
+  void begin_variant() { }
+  void end_variant() { }
+  stream_type &stream() { return stream_; }
+
+  template <class T>
+  void serialize_int(T &v)
+  {
+    serialize_uint(*(typename boost::make_unsigned<T>::type *)&v);
+  }
+
+  template <class T>
+  void serialize_uint(T &v, size_t width = sizeof(T))
+  {
+    T ret = 0;
+    unsigned shift = 0;
+    for (size_t i = 0; i < width; i++) {
+      uint8_t c;
+      if (!stream_.get(c))
+        return;
+      ret += (T(c) << shift);
+      shift += 8;
+    }
+    v = ret;
+  }
+  void serialize_blob(void *buf, size_t len, const char *delimiter="") { stream_.read(buf, len); }
+
+  template <class T>
+  void serialize_varint(T &v)
+  {
+    serialize_uvarint(*(typename boost::make_unsigned<T>::type *)(&v));
+  }
+
+  //same acceptance rules as tools::read_varint over a stream, so parsing results do not change
+  template <class T>
+  void serialize_uvarint(T &v)
+  {
+    const int bits = std::numeric_limits<T>::digits;
+    v = 0;
+    for (int shift = 0;; shift += 7) {
+      if (stream_.remaining() == 0)
+        return;
+      uint8_t byte;
+      stream_.get(byte);
+      if (shift + 7 >= bits && byte >= 1 << (bits - shift))
+        return;
+      if (byte == 0 && shift != 0)
+        return;
+      v |= static_cast<T>(byte & 0x7f) << shift;
+      if ((byte & 0x80) == 0)
+        return;
+    }
+  }
+  void begin_array(size_t &s)
+  {
+    serialize_varint(s);
+  }
+  void begin_array() { }
+
+  void delimit_array() { }
+  void end_array() { }
+
+  void begin_string(const char *delimiter="\"") { }
+  void end_string(const char *delimiter="\"") { }
+
+  void read_variant_tag(variant_tag_type &t) {
+    serialize_int(t);
+  }
+
+  size_t remaining_bytes() {
+    return stream_.good() ? stream_.remaining() : 0;
+  }
+protected:
+  stream_type stream_;
+};
+
+template <class Archive, class T>
+struct variant_serialization_traits;
+
+//variant tags are registered for binary_archive only
+template <class T>
+struct variant_serialization_traits<memory_binary_archive<false>, T> : variant_serialization_traits<binary_archive<false>, T>
+{
+};
+
 POP_WARNINGS
@@ -13,8 +13,7 @@ namespace serialization {
 template <class T>
 bool parse_binary(const std::string &blob, T &v)
 {
-  std::istringstream istr(blob);
-  binary_archive<false> iar(istr);
+  memory_binary_archive<false> iar(blob);
   return ::serialization::serialize(iar, v);
 }
 
@@ -21,19 +21,15 @@ bool do_serialize(Archive<false> &ar, std::vector<crypto::signature> &v)
   v.clear();
 
   // very basic sanity check
-  if (ar.remaining_bytes() < cnt*sizeof(crypto::signature)) {
+  if (ar.remaining_bytes() / sizeof(crypto::signature) < cnt) {
     ar.stream().setstate(std::ios::failbit);
     return false;
   }
 
-  v.reserve(cnt);
-  for (size_t i = 0; i < cnt; i++) {
-    v.resize(i+1);
-    ar.serialize_blob(&(v[i]), sizeof(crypto::signature), "");
-    if (!ar.stream().good())
-      return false;
-  }
-  return true;
+  v.resize(cnt);
+  if (cnt != 0)
+    ar.serialize_blob(v.data(), cnt * sizeof(crypto::signature), "");
+  return ar.stream().good();
 }
 
 // write
@@ -42,12 +38,9 @@ bool do_serialize(Archive<true> &ar, std::vector<crypto::signature> &v)
 {
   if (0 == v.size()) return true;
   ar.begin_string();
-  size_t cnt = v.size();
-  for (size_t i = 0; i < cnt; i++) {
-    ar.serialize_blob(&(v[i]), sizeof(crypto::signature), "");
-    if (!ar.stream().good())
-      return false;
-  }
+  ar.serialize_blob(v.data(), v.size() * sizeof(crypto::signature), "");
+  if (!ar.stream().good())
+    return false;
   ar.end_string();
   return true;
 }
@@ -7,6 +7,9 @@
 
 #include "serialization.h"
 
+template <bool W>
+struct binary_archive;
+
 namespace serialization
 {
   namespace detail
@@ -30,6 +33,62 @@ namespace serialization
       ar.serialize_varint(e);
       return true;
     }
+
+    template <typename Archive, class T>
+    bool serialize_vector_elements(Archive& ar, std::vector<T>& v, size_t cnt, boost::false_type)
+    {
+      v.reserve(cnt);
+      for (size_t i = 0; i < cnt; i++) {
+        if (i > 0)
+          ar.delimit_array();
+        v.resize(i+1);
+        if (!serialize_vector_element(ar, v[i]))
+          return false;
+        if (!ar.stream().good())
+          return false;
+      }
+      return true;
+    }
+
+    // blobs are stored back to back, so they are read with a single copy
+    template <typename Archive, class T>
+    bool serialize_vector_elements(Archive& ar, std::vector<T>& v, size_t cnt, boost::true_type)
+    {
+      if (ar.remaining_bytes() / sizeof(T) < cnt) {
+        ar.stream().setstate(std::ios::failbit);
+        return false;
+      }
+
+      v.resize(cnt);
+      if (cnt != 0)
+        ar.serialize_blob(v.data(), cnt * sizeof(T));
+      return ar.stream().good();
+    }
+
+    template <typename Archive, class T, class IsBlob>
+    bool serialize_vector_elements(Archive& ar, std::vector<T>& v, IsBlob)
+    {
+      for (size_t i = 0; i < v.size(); i++) {
+        if (!ar.stream().good())
+          return false;
+        if (i > 0)
+          ar.delimit_array();
+        if (!serialize_vector_element(ar, v[i]))
+          return false;
+        if (!ar.stream().good())
+          return false;
+      }
+      return true;
+    }
+
+    // text archives delimit every element, the binary one writes blobs back to back in one go
+    template <class T>
+    bool serialize_vector_elements(binary_archive<true>& ar, std::vector<T>& v, boost::true_type)
+    {
+      if (!v.empty())
+        ar.serialize_blob(v.data(), v.size() * sizeof(T));
+      return ar.stream().good();
+    }
   }
 }
 
@@ -48,16 +107,8 @@ bool do_serialize(Archive<false> &ar, std::vector<T> &v)
     return false;
   }
 
-  v.reserve(cnt);
-  for (size_t i = 0; i < cnt; i++) {
-    if (i > 0)
-      ar.delimit_array();
-    v.resize(i+1);
-    if (!::serialization::detail::serialize_vector_element(ar, v[i]))
-      return false;
-    if (!ar.stream().good())
-      return false;
-  }
+  if (!::serialization::detail::serialize_vector_elements(ar, v, cnt, typename is_blob_type<T>::type()))
+    return false;
   ar.end_array();
   return true;
 }
@@ -67,16 +118,8 @@ bool do_serialize(Archive<true> &ar, std::vector<T> &v)
 {
   size_t cnt = v.size();
   ar.begin_array(cnt);
-  for (size_t i = 0; i < cnt; i++) {
-    if (!ar.stream().good())
-      return false;
-    if (i > 0)
-      ar.delimit_array();
-    if(!::serialization::detail::serialize_vector_element(ar, v[i]))
-      return false;
-    if (!ar.stream().good())
-      return false;
-  }
+  if (!::serialization::detail::serialize_vector_elements(ar, v, typename is_blob_type<T>::type()))
+    return false;
   ar.end_array();
   return true;
 }
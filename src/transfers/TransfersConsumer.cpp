@@ -14,70 +14,96 @@
 #include "IWallet.h"
 #include "INode.h"
 #include <future>
+#include <memory>
 
 namespace {
 
 using namespace CryptoNote;
 
-void checkOutputKey(
-  const crypto::key_derivation& derivation,
-  const PublicKey& key,
-  size_t keyIndex,
-  size_t outputIndex,
-  const std::unordered_set<PublicKey>& spendKeys,
-  std::unordered_map<PublicKey, std::vector<uint32_t>>& outputs) {
-
-  PublicKey spendKey;
-  crypto::underive_public_key(derivation, keyIndex,
-    reinterpret_cast<const crypto::public_key&>(key),
-    reinterpret_cast<crypto::public_key&>(spendKey));
-
-  if (spendKeys.find(spendKey) != spendKeys.end()) {
-    outputs[spendKey].push_back(static_cast<uint32_t>(outputIndex));
-  }
-
-}
+// transactions preprocessed together, their outputs share the batched key operations
+const size_t TRANSACTIONS_PER_BATCH = 32;
 
 void findMyOutputs(
-  const ITransactionReader& tx,
+  const std::vector<const ITransactionReader*>& txs,
   const SecretKey& viewSecretKey,
   const std::unordered_set<PublicKey>& spendKeys,
-  std::unordered_map<PublicKey, std::vector<uint32_t>>& outputs) {
+  std::vector<std::unordered_map<PublicKey, std::vector<uint32_t>>>& outputs) {
 
-  auto txPublicKey = tx.getTransactionPublicKey();
-  crypto::key_derivation derivation;
+  outputs.clear();
+  outputs.resize(txs.size());
 
-  if (!crypto::generate_key_derivation(
-    reinterpret_cast<const crypto::public_key&>(txPublicKey),
-    reinterpret_cast<const crypto::secret_key&>(viewSecretKey), 
-    derivation)) {
-    return;
+  std::vector<crypto::public_key> txPublicKeys;
+  txPublicKeys.reserve(txs.size());
+  for (auto tx : txs) {
+    auto txPublicKey = tx->getTransactionPublicKey();
+    txPublicKeys.push_back(reinterpret_cast<const crypto::public_key&>(txPublicKey));
   }
 
-  size_t keyIndex = 0;
-  size_t outputCount = tx.getOutputCount();
+  std::vector<crypto::key_derivation> derivations(txs.size());
+  std::unique_ptr<bool[]> derivationValid(new bool[txs.size()]);
+  crypto::generate_key_derivations(txPublicKeys.data(), txPublicKeys.size(),
+    reinterpret_cast<const crypto::secret_key&>(viewSecretKey), derivations.data(), derivationValid.get());
+
+  // output keys of all transactions, one entry per key
+  std::vector<crypto::key_derivation> keyDerivations;
+  std::vector<size_t> keyIndexes;
+  std::vector<crypto::public_key> outputKeys;
+  std::vector<std::pair<size_t, uint32_t>> keyOwners; // transaction, output index
+
+  auto addOutputKey = [&](size_t txIdx, const PublicKey& key, size_t keyIndex, size_t outputIndex) {
+    keyDerivations.push_back(derivations[txIdx]);
+    keyIndexes.push_back(keyIndex);
+    outputKeys.push_back(reinterpret_cast<const crypto::public_key&>(key));
+    keyOwners.emplace_back(txIdx, static_cast<uint32_t>(outputIndex));
+  };
 
-  for (size_t idx = 0; idx < outputCount; ++idx) {
+  for (size_t txIdx = 0; txIdx < txs.size(); ++txIdx) {
+    if (!derivationValid[txIdx]) {
+      continue;
+    }
 
-    auto outType = tx.getOutputType(size_t(idx));
+    const ITransactionReader& tx = *txs[txIdx];
+    size_t keyIndex = 0;
+    size_t outputCount = tx.getOutputCount();
 
-    if (outType == TransactionTypes::OutputType::Key) {
+    for (size_t idx = 0; idx < outputCount; ++idx) {
 
-      TransactionTypes::OutputKey out;
-      tx.getOutput(idx, out);
-      checkOutputKey(derivation, out.key, keyIndex, idx, spendKeys, outputs);
-      ++keyIndex;
+      auto outType = tx.getOutputType(size_t(idx));
 
-    } else if (outType == TransactionTypes::OutputType::Multisignature) {
+      if (outType == TransactionTypes::OutputType::Key) {
 
-      TransactionTypes::OutputMultisignature out;
-      tx.getOutput(idx, out);
-      for (const auto& key : out.keys) {
-        checkOutputKey(derivation, key, idx, idx, spendKeys, outputs);
+        TransactionTypes::OutputKey out;
+        tx.getOutput(idx, out);
+        addOutputKey(txIdx, out.key, keyIndex, idx);
         ++keyIndex;
+
+      } else if (outType == TransactionTypes::OutputType::Multisignature) {
+
+        TransactionTypes::OutputMultisignature out;
+        tx.getOutput(idx, out);
+        for (const auto& key : out.keys) {
+          addOutputKey(txIdx, key, idx, idx);
+          ++keyIndex;
+        }
       }
     }
   }
+
+  std::vector<crypto::public_key> candidateSpendKeys(outputKeys.size());
+  std::unique_ptr<bool[]> candidateValid(new bool[outputKeys.size()]);
+  crypto::underive_public_keys(keyDerivations.data(), keyIndexes.data(), outputKeys.data(), outputKeys.size(),
+    candidateSpendKeys.data(), candidateValid.get());
+
+  for (size_t i = 0; i < candidateSpendKeys.size(); ++i) {
+    if (!candidateValid[i]) {
+      continue;
+    }
+
+    const PublicKey& spendKey = reinterpret_cast<const PublicKey&>(candidateSpendKeys[i]);
+    if (spendKeys.find(spendKey) != spendKeys.end()) {
+      outputs[keyOwners[i].first][spendKey].push_back(keyOwners[i].second);
+    }
+  }
 }
 
 }
@@ -166,11 +192,12 @@ bool TransfersConsumer::onNewBlocks(const CompleteBlock* blocks, uint64_t startH
     workers = 2;
   }
 
-  BlockingQueue<Tx> inputQueue(workers * 2);
+  BlockingQueue<std::vector<Tx>> inputQueue(workers * 2);
 
   std::atomic<bool> stopProcessing(false);
 
   auto pushingThread = std::async(std::launch::async, [&] {
+    std::vector<Tx> batch;
     for (size_t i = 0; i < count && !stopProcessing; ++i) {
       const auto& block = blocks[i].block;
 
@@ -195,29 +222,47 @@ bool TransfersConsumer::onNewBlocks(const CompleteBlock* blocks, uint64_t startH
         }
 
         Tx item = { blockInfo, tx.get() };
-        inputQueue.push(item);
+        batch.push_back(item);
         ++blockInfo.transactionIndex;
+
+        if (batch.size() == TRANSACTIONS_PER_BATCH) {
+          inputQueue.push(std::move(batch));
+          batch.clear();
+        }
       }
     }
 
+    if (!batch.empty()) {
+      inputQueue.push(std::move(batch));
+    }
+
     inputQueue.close();
   });
 
   auto processingFunction = [&] {
-    Tx item;
+    std::vector<Tx> batch;
     std::error_code ec;
-    while (!stopProcessing && inputQueue.pop(item)) {
-      PreprocessedTx output;
-      static_cast<Tx&>(output) = item;
+    while (!stopProcessing && inputQueue.pop(batch)) {
+      std::vector<const ITransactionReader*> txs;
+      txs.reserve(batch.size());
+      for (const auto& item : batch) {
+        txs.push_back(item.tx);
+      }
 
-      ec = preprocessOutputs(item.blockInfo, *item.tx, output);
+      std::vector<PreprocessInfo> infos;
+      ec = preprocessOutputs(txs, infos);
       if (ec) {
         stopProcessing = true;
         break;
       }
 
       std::lock_guard<std::mutex> lk(preprocessedTransactionsMutex);
-      preprocessedTransactions.push_back(std::move(output));
+      for (size_t i = 0; i < batch.size(); ++i) {
+        PreprocessedTx output;
+        static_cast<Tx&>(output) = batch[i];
+        static_cast<PreprocessInfo&>(output) = std::move(infos[i]);
+        preprocessedTransactions.push_back(std::move(output));
+      }
     }
     return ec;
   };
@@ -312,7 +357,9 @@ void TransfersConsumer::getKnownPoolTxIds(std::vector<crypto::hash>& ids) {
 }
 
 std::error_code TransfersConsumer::preprocessOutputs(const BlockInfo& blockInfo, const ITransactionReader& tx, PreprocessInfo& info) {
-  findMyOutputs(tx, m_viewSecret, m_spendKeys, info.outputs);
+  std::vector<std::unordered_map<PublicKey, std::vector<uint32_t>>> outputs;
+  findMyOutputs({ &tx }, m_viewSecret, m_spendKeys, outputs);
+  info.outputs = std::move(outputs.front());
 
   std::error_code errorCode;
   if (!info.outputs.empty()) {
@@ -328,6 +375,25 @@ std::error_code TransfersConsumer::preprocessOutputs(const BlockInfo& blockInfo,
   return std::error_code();
 }
 
+std::error_code TransfersConsumer::preprocessOutputs(const std::vector<const ITransactionReader*>& txs, std::vector<PreprocessInfo>& infos) {
+  std::vector<std::unordered_map<PublicKey, std::vector<uint32_t>>> outputs;
+  findMyOutputs(txs, m_viewSecret, m_spendKeys, outputs);
+
+  infos.resize(txs.size());
+  for (size_t i = 0; i < txs.size(); ++i) {
+    infos[i].outputs = std::move(outputs[i]);
+    if (!infos[i].outputs.empty()) {
+      auto txHash = txs[i]->getTransactionHash();
+      std::error_code errorCode = getGlobalIndices(reinterpret_cast<const crypto::hash&>(txHash), infos[i].globalIdxs);
+      if (errorCode) {
+        return errorCode;
+      }
+    }
+  }
+
+  return std::error_code();
+}
+
 std::error_code TransfersConsumer::processTransaction(const BlockInfo& blockInfo, const ITransactionReader& tx) {
   PreprocessInfo info;
   auto ec = preprocessOutputs(blockInfo, tx, info);
@@ -54,6 +54,8 @@ private:
   };
 
   std::error_code preprocessOutputs(const BlockInfo& blockInfo, const ITransactionReader& tx, PreprocessInfo& info);
+  // batch of transactions already in the blockchain
+  std::error_code preprocessOutputs(const std::vector<const ITransactionReader*>& txs, std::vector<PreprocessInfo>& infos);
   std::error_code processTransaction(const BlockInfo& blockInfo, const ITransactionReader& tx);
   std::error_code processTransaction(const BlockInfo& blockInfo, const ITransactionReader& tx, const PreprocessInfo& info);
   std::error_code processOutputs(const BlockInfo& blockInfo, TransfersSubscription& sub, const ITransactionReader& tx,
@@ -59,6 +59,7 @@ namespace tests
     bool get_blockchain_top(uint64_t& height, crypto::hash& top_id);
     bool handle_incoming_tx(const cryptonote::blobdata& tx_blob, cryptonote::tx_verification_context& tvc, bool keeped_by_block);
     bool handle_incoming_block_blob(const cryptonote::blobdata& block_blob, cryptonote::block_verification_context& bvc, bool control_miner, bool relay_block);
+    void precompute_proof_of_work(const std::vector<cryptonote::Block>& blocks){}
     void pause_mining(){}
     void update_block_template_and_resume_mining(){}
     bool on_idle(){return true;}
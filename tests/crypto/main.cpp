@@ -119,6 +119,17 @@ int main(int argc, char *argv[]) {
       if (expected1 != actual1 || (expected1 && expected2 != actual2)) {
         goto error;
       }
+      {
+        public_key keys[2] = { key1, key1 };
+        key_derivation derivations[2];
+        bool valid[2];
+        generate_key_derivations(keys, 2, key2, derivations, valid);
+        for (size_t i = 0; i < 2; ++i) {
+          if (expected1 != valid[i] || (expected1 && expected2 != derivations[i])) {
+            goto error;
+          }
+        }
+      }
     } else if (cmd == "derive_public_key") {
       key_derivation derivation;
       size_t output_index;
@@ -157,6 +168,19 @@ int main(int argc, char *argv[]) {
       if (expected1 != actual1 || (expected1 && expected2 != actual2)) {
         goto error;
       }
+      {
+        key_derivation derivations[2] = { derivation, derivation };
+        size_t output_indexes[2] = { output_index, output_index };
+        public_key derived_keys[2] = { derived_key, derived_key };
+        public_key bases[2];
+        bool valid[2];
+        underive_public_keys(derivations, output_indexes, derived_keys, 2, bases, valid);
+        for (size_t i = 0; i < 2; ++i) {
+          if (expected1 != valid[i] || (expected1 && expected2 != bases[i])) {
+            goto error;
+          }
+        }
+      }
     } else if (cmd == "generate_signature") {
       chash prefix_hash;
       public_key pub;
@@ -4,10 +4,12 @@
 // file COPYING or http://www.opensource.org/licenses/mit-license.php.
 
 #include <cstddef>
+#include <cstring>
 #include <fstream>
 #include <iomanip>
 #include <ios>
 #include <string>
+#include <vector>
 
 #include "warnings.h"
 #include "crypto/hash.h"
@@ -18,6 +20,59 @@ using namespace crypto;
 typedef crypto::hash chash;
 
 cn_context *context;
+cn_context *ways_context;
+
+//lane 0 hashes the test input and must match the expected hash, the other lanes hash variants
+//of it and must match the one way hash, so a lane reading another lane's state shows up
+static void slow_hash_ways(const void *data, size_t length, char *hash) {
+  size_t ways = ways_context->get_ways();
+  vector<vector<char>> inputs(ways, vector<char>(static_cast<const char *>(data), static_cast<const char *>(data) + length));
+  vector<const void *> pointers(ways);
+  vector<chash> results(ways);
+  for (size_t w = 0; w < ways; w++) {
+    for (size_t i = 0; i < length; i++) {
+      inputs[w][i] ^= static_cast<char>(w);
+    }
+    pointers[w] = inputs[w].data();
+  }
+  cn_slow_hash_ways(*ways_context, pointers.data(), length, results.data());
+  for (size_t w = 1; w < ways; w++) {
+    chash expected;
+    cn_slow_hash(*context, pointers[w], length, expected);
+    if (expected != results[w]) {
+      memset(&results[0], 0, sizeof(chash));
+    }
+  }
+  memcpy(hash, &results[0], sizeof(chash));
+}
+
+//the test input is hashed in a batch with longer inputs, which must match their one input hash,
+//so lanes finishing at different blocks and taking the next input are covered
+static void fast_hash_batch(const void *data, size_t length, char *hash) {
+  const size_t count = 9;
+  const size_t tested = 5;
+  vector<vector<char>> inputs(count);
+  vector<const void *> pointers(count);
+  vector<size_t> lengths(count);
+  vector<chash> results(count);
+  for (size_t i = 0; i < count; i++) {
+    inputs[i].assign(static_cast<const char *>(data), static_cast<const char *>(data) + length);
+    if (i != tested) {
+      inputs[i].resize(length + 67 * (i + 1), static_cast<char>(i));
+    }
+    pointers[i] = inputs[i].data();
+    lengths[i] = inputs[i].size();
+  }
+  cn_fast_hash_n(pointers.data(), lengths.data(), count, results.data());
+  for (size_t i = 0; i < count; i++) {
+    chash expected;
+    cn_fast_hash(pointers[i], lengths[i], expected);
+    if (expected != results[i]) {
+      memset(&results[tested], 0, sizeof(chash));
+    }
+  }
+  memcpy(hash, &results[tested], sizeof(chash));
+}
 
 extern "C" {
 
@@ -31,16 +86,28 @@ DISABLE_VS_WARNINGS(4297)
   }
 POP_WARNINGS
 
+  static void fast_hash_n(const void *data, size_t length, char *hash) {
+    fast_hash_batch(data, length, hash);
+  }
+
   static void slow_hash(const void *data, size_t length, char *hash) {
     cn_slow_hash(*context, data, length, *reinterpret_cast<chash *>(hash));
   }
+
+  static void slow_hash_2(const void *data, size_t length, char *hash) {
+    slow_hash_ways(data, length, hash);
+  }
+
+  static void slow_hash_4(const void *data, size_t length, char *hash) {
+    slow_hash_ways(data, length, hash);
+  }
 }
 
 extern "C" typedef void hash_f(const void *, size_t, char *);
 struct hash_func {
   const string name;
   hash_f &f;
-} hashes[] = {{"fast", cn_fast_hash}, {"slow", slow_hash}, {"tree", hash_tree},
+} hashes[] = {{"fast", cn_fast_hash}, {"fast-n", fast_hash_n}, {"slow", slow_hash}, {"slow-2", slow_hash_2}, {"slow-4", slow_hash_4}, {"tree", hash_tree},
   {"extra-blake", hash_extra_blake}, {"extra-groestl", hash_extra_groestl},
   {"extra-jh", hash_extra_jh}, {"extra-skein", hash_extra_skein}};
 
@@ -66,9 +133,14 @@ int main(int argc, char *argv[]) {
       break;
     }
   }
-  if (f == slow_hash) {
+  if (f == slow_hash || f == slow_hash_2 || f == slow_hash_4) {
     context = new cn_context();
   }
+  if (f == slow_hash_2) {
+    ways_context = new cn_context(2);
+  } else if (f == slow_hash_4) {
+    ways_context = new cn_context(4);
+  }
   input.open(argv[2], ios_base::in);
   for (;;) {
     ++test;
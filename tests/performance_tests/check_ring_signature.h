@@ -15,7 +15,7 @@
 #include "multi_tx_test_base.h"
 
 template<size_t a_ring_size>
-class test_check_ring_signature : private multi_tx_test_base<a_ring_size>
+class test_check_ring_signature : protected multi_tx_test_base<a_ring_size>
 {
   static_assert(0 < a_ring_size, "ring_size must be greater than 0");
 
@@ -51,8 +51,45 @@ public:
     return crypto::check_ring_signature(m_tx_prefix_hash, txin.keyImage, this->m_public_key_ptrs, ring_size, m_tx.signatures[0].data());
   }
 
-private:
+protected:
   cryptonote::account_base m_alice;
   cryptonote::Transaction m_tx;
   crypto::hash m_tx_prefix_hash;
 };
+
+//ring members already prepared, as when every key is found in the output key cache
+template<size_t a_ring_size>
+class test_check_prepared_ring_signature : public test_check_ring_signature<a_ring_size>
+{
+public:
+  static const size_t loop_count = a_ring_size < 100 ? 100 : 10;
+  static const size_t ring_size = a_ring_size;
+
+  typedef test_check_ring_signature<a_ring_size> base_class;
+
+  bool init()
+  {
+    if (!base_class::init())
+      return false;
+
+    m_prepared_keys.resize(ring_size);
+    for (size_t i = 0; i < ring_size; ++i)
+    {
+      if (!crypto::prepare_public_key(*this->m_public_key_ptrs[i], m_prepared_keys[i]))
+        return false;
+      m_prepared_key_ptrs.push_back(&m_prepared_keys[i]);
+    }
+
+    return true;
+  }
+
+  bool test()
+  {
+    const cryptonote::TransactionInputToKey& txin = boost::get<cryptonote::TransactionInputToKey>(this->m_tx.vin[0]);
+    return crypto::check_ring_signature(this->m_tx_prefix_hash, txin.keyImage, m_prepared_key_ptrs, this->m_tx.signatures[0].data());
+  }
+
+private:
+  std::vector<crypto::prepared_public_key> m_prepared_keys;
+  std::vector<const crypto::prepared_public_key*> m_prepared_key_ptrs;
+};
@@ -0,0 +1,130 @@
+// Copyright (c) 2011-2015 The Cryptonote developers
+// Copyright (c) 2014-2015 XDN developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#pragma once
+
+#include <vector>
+
+#include "crypto/crypto.h"
+#include "crypto/hash.h"
+#include "cryptonote_core/cryptonote_format_utils.h"
+
+#include "serialize_block.h"
+#include "serialize_transaction.h"
+
+template<size_t a_in_count, size_t a_out_count, size_t a_ring_size>
+class test_get_transaction_hash : private tx_serialization_test_base<a_in_count, a_out_count, a_ring_size>
+{
+public:
+  static const size_t loop_count = 1000;
+
+  typedef tx_serialization_test_base<a_in_count, a_out_count, a_ring_size> base_class;
+
+  bool init()
+  {
+    if (!base_class::init())
+      return false;
+
+    m_expected_hash = cryptonote::get_transaction_hash(this->m_tx);
+    return true;
+  }
+
+  bool test()
+  {
+    return cryptonote::get_transaction_hash(this->m_tx) == m_expected_hash;
+  }
+
+private:
+  crypto::hash m_expected_hash;
+};
+
+template<size_t a_tx_count>
+class test_get_block_hash : private block_test_base<a_tx_count>
+{
+public:
+  static const size_t loop_count = 1000;
+
+  typedef block_test_base<a_tx_count> base_class;
+
+  bool init()
+  {
+    if (!base_class::init())
+      return false;
+
+    m_expected_hash = cryptonote::get_block_hash(this->m_block);
+    return true;
+  }
+
+  bool test()
+  {
+    return cryptonote::get_block_hash(this->m_block) == m_expected_hash;
+  }
+
+private:
+  crypto::hash m_expected_hash;
+};
+
+template<size_t a_hash_count>
+class test_get_tx_tree_hash
+{
+public:
+  static const size_t loop_count = 1000;
+  static const size_t hash_count = a_hash_count;
+
+  bool init()
+  {
+    for (size_t i = 0; i < hash_count; ++i)
+    {
+      m_hashes.push_back(crypto::rand<crypto::hash>());
+    }
+
+    m_expected_hash = cryptonote::get_tx_tree_hash(m_hashes);
+    return true;
+  }
+
+  bool test()
+  {
+    return cryptonote::get_tx_tree_hash(m_hashes) == m_expected_hash;
+  }
+
+private:
+  std::vector<crypto::hash> m_hashes;
+  crypto::hash m_expected_hash;
+};
+
+template<size_t a_blob_count, size_t a_blob_size>
+class test_get_blob_hashes
+{
+public:
+  static const size_t loop_count = 100;
+
+  bool init()
+  {
+    for (size_t i = 0; i < a_blob_count; ++i)
+    {
+      cryptonote::blobdata blob(a_blob_size, '\0');
+      for (char& c : blob)
+      {
+        c = crypto::rand<char>();
+      }
+
+      m_blobs.push_back(blob);
+      m_expected_hashes.push_back(cryptonote::get_blob_hash(blob));
+    }
+
+    return true;
+  }
+
+  bool test()
+  {
+    cryptonote::get_blob_hashes(m_blobs, m_hashes);
+    return m_hashes == m_expected_hashes;
+  }
+
+private:
+  std::vector<cryptonote::blobdata> m_blobs;
+  std::vector<crypto::hash> m_hashes;
+  std::vector<crypto::hash> m_expected_hashes;
+};
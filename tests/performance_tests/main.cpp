@@ -16,10 +16,34 @@
 #include "generate_key_derivation.h"
 #include "generate_key_image.h"
 #include "generate_key_image_helper.h"
+#include "hash_objects.h"
 #include "is_out_to_acc.h"
+#include "serialize_block.h"
+#include "serialize_block_entries.h"
+#include "serialize_transaction.h"
+#include "underive_public_keys.h"
 
 int main(int argc, char** argv)
 {
+  performance_options& options = get_performance_options();
+  for (int i = 1; i < argc; i += 2)
+  {
+    std::string arg = argv[i];
+    if (i + 1 < argc && arg == "--filter")
+    {
+      options.filter = argv[i + 1];
+    }
+    else if (i + 1 < argc && arg == "--csv")
+    {
+      options.csv_path = argv[i + 1];
+    }
+    else
+    {
+      std::cerr << "Usage: " << argv[0] << " [--filter <test name substring>] [--csv <results file>]" << std::endl;
+      return 1;
+    }
+  }
+
   set_process_affinity(1);
   set_thread_high_priority();
 
@@ -49,19 +73,90 @@ int main(int argc, char** argv)
 
   TEST_PERFORMANCE1(test_check_ring_signature, 1);
   TEST_PERFORMANCE1(test_check_ring_signature, 2);
+  TEST_PERFORMANCE1(test_check_ring_signature, 3);
+  TEST_PERFORMANCE1(test_check_ring_signature, 5);
   TEST_PERFORMANCE1(test_check_ring_signature, 10);
+  TEST_PERFORMANCE1(test_check_ring_signature, 20);
+  TEST_PERFORMANCE1(test_check_ring_signature, 50);
   TEST_PERFORMANCE1(test_check_ring_signature, 100);
 
+  TEST_PERFORMANCE1(test_check_prepared_ring_signature, 10);
+  TEST_PERFORMANCE1(test_check_prepared_ring_signature, 100);
+
   TEST_PERFORMANCE0(test_is_out_to_acc);
   TEST_PERFORMANCE0(test_generate_key_image_helper);
   TEST_PERFORMANCE0(test_generate_key_derivation);
   TEST_PERFORMANCE0(test_generate_key_image);
   TEST_PERFORMANCE0(test_derive_public_key);
   TEST_PERFORMANCE0(test_derive_secret_key);
+  TEST_PERFORMANCE1(test_underive_public_keys, 1);
+  TEST_PERFORMANCE1(test_underive_public_keys, 64);
 
   TEST_PERFORMANCE0(test_cn_slow_hash);
 
+  TEST_PERFORMANCE4(test_serialize_transaction, binary_archive_format, 1, 2, 1);
+  TEST_PERFORMANCE4(test_serialize_transaction, binary_archive_format, 2, 2, 10);
+  TEST_PERFORMANCE4(test_serialize_transaction, binary_archive_format, 10, 10, 10);
+  TEST_PERFORMANCE4(test_serialize_transaction, binary_serializer_format, 1, 2, 1);
+  TEST_PERFORMANCE4(test_serialize_transaction, binary_serializer_format, 2, 2, 10);
+  TEST_PERFORMANCE4(test_serialize_transaction, binary_serializer_format, 10, 10, 10);
+  TEST_PERFORMANCE4(test_serialize_transaction, json_format, 1, 2, 1);
+  TEST_PERFORMANCE4(test_serialize_transaction, json_format, 10, 10, 10);
+  TEST_PERFORMANCE4(test_serialize_transaction, boost_binary_format, 1, 2, 1);
+  TEST_PERFORMANCE4(test_serialize_transaction, boost_binary_format, 10, 10, 10);
+
+  TEST_PERFORMANCE4(test_parse_transaction, binary_archive_format, 1, 2, 1);
+  TEST_PERFORMANCE4(test_parse_transaction, binary_archive_format, 2, 2, 10);
+  TEST_PERFORMANCE4(test_parse_transaction, binary_archive_format, 10, 10, 10);
+  TEST_PERFORMANCE4(test_parse_transaction, binary_serializer_format, 1, 2, 1);
+  TEST_PERFORMANCE4(test_parse_transaction, binary_serializer_format, 2, 2, 10);
+  TEST_PERFORMANCE4(test_parse_transaction, binary_serializer_format, 10, 10, 10);
+  TEST_PERFORMANCE4(test_parse_transaction, json_format, 1, 2, 1);
+  TEST_PERFORMANCE4(test_parse_transaction, json_format, 10, 10, 10);
+  TEST_PERFORMANCE4(test_parse_transaction, boost_binary_format, 1, 2, 1);
+  TEST_PERFORMANCE4(test_parse_transaction, boost_binary_format, 10, 10, 10);
+
+  TEST_PERFORMANCE2(test_serialize_block, binary_archive_format, 0);
+  TEST_PERFORMANCE2(test_serialize_block, binary_archive_format, 100);
+  TEST_PERFORMANCE2(test_serialize_block, binary_serializer_format, 0);
+  TEST_PERFORMANCE2(test_serialize_block, binary_serializer_format, 100);
+  TEST_PERFORMANCE2(test_serialize_block, json_format, 100);
+  TEST_PERFORMANCE2(test_serialize_block, boost_binary_format, 100);
+
+  TEST_PERFORMANCE2(test_parse_block, binary_archive_format, 0);
+  TEST_PERFORMANCE2(test_parse_block, binary_archive_format, 100);
+  TEST_PERFORMANCE2(test_parse_block, binary_serializer_format, 0);
+  TEST_PERFORMANCE2(test_parse_block, binary_serializer_format, 100);
+  TEST_PERFORMANCE2(test_parse_block, json_format, 100);
+  TEST_PERFORMANCE2(test_parse_block, boost_binary_format, 100);
+
+  TEST_PERFORMANCE3(test_serialize_block_entries, epee_portable_storage_format, 200, 5);
+  TEST_PERFORMANCE3(test_serialize_block_entries, kv_binary_format, 200, 5);
+  TEST_PERFORMANCE3(test_serialize_block_entries, binary_serializer_format, 200, 5);
+  TEST_PERFORMANCE3(test_serialize_block_entries, json_format, 200, 5);
+
+  TEST_PERFORMANCE3(test_parse_block_entries, epee_portable_storage_format, 200, 5);
+  TEST_PERFORMANCE3(test_parse_block_entries, kv_binary_format, 200, 5);
+  TEST_PERFORMANCE3(test_parse_block_entries, binary_serializer_format, 200, 5);
+  TEST_PERFORMANCE3(test_parse_block_entries, json_format, 200, 5);
+
+  TEST_PERFORMANCE3(test_get_transaction_hash, 1, 2, 1);
+  TEST_PERFORMANCE3(test_get_transaction_hash, 10, 10, 10);
+  TEST_PERFORMANCE1(test_get_block_hash, 0);
+  TEST_PERFORMANCE1(test_get_block_hash, 100);
+  TEST_PERFORMANCE1(test_get_tx_tree_hash, 2);
+  TEST_PERFORMANCE1(test_get_tx_tree_hash, 100);
+  TEST_PERFORMANCE1(test_get_tx_tree_hash, 1000);
+  TEST_PERFORMANCE2(test_get_blob_hashes, 1000, 64);
+  TEST_PERFORMANCE2(test_get_blob_hashes, 100, 1000);
+
   std::cout << "Tests finished. Elapsed time: " << timer.elapsed_ms() / 1000 << " sec" << std::endl;
 
+  if (!options.csv_path.empty() && !write_performance_csv(options.csv_path))
+  {
+    std::cerr << "Failed to write " << options.csv_path << std::endl;
+    return 1;
+  }
+
   return 0;
 }
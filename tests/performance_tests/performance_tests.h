@@ -5,7 +5,10 @@
 
 #pragma once
 
+#include <fstream>
 #include <iostream>
+#include <string>
+#include <vector>
 #include <stdint.h>
 
 #include <boost/chrono.hpp>
@@ -31,6 +34,12 @@ public:
     return static_cast<int>(boost::chrono::duration_cast<boost::chrono::milliseconds>(elapsed).count());
   }
 
+  int64_t elapsed_us()
+  {
+    clock::duration elapsed = clock::now() - m_start;
+    return static_cast<int64_t>(boost::chrono::duration_cast<boost::chrono::microseconds>(elapsed).count());
+  }
+
 private:
   clock::time_point m_base;
   clock::time_point m_start;
@@ -42,7 +51,7 @@ class test_runner
 {
 public:
   test_runner()
-    : m_elapsed(0)
+    : m_elapsed_us(0)
   {
   }
 
@@ -63,17 +72,17 @@ public:
       if (!test.test())
         return false;
     }
-    m_elapsed = timer.elapsed_ms();
+    m_elapsed_us = timer.elapsed_us();
 
     return true;
   }
 
-  int elapsed_time() const { return m_elapsed; }
+  int elapsed_time() const { return static_cast<int>(m_elapsed_us / 1000); }
 
-  int time_per_call() const
+  double time_per_call_us() const
   {
     static_assert(0 < T::loop_count, "T::loop_count must be greater than 0");
-    return m_elapsed / T::loop_count;
+    return static_cast<double>(m_elapsed_us) / T::loop_count;
   }
 
 private:
@@ -93,27 +102,72 @@ private:
 
 private:
   volatile uint64_t m_warm_up;  ///<! This field is intended for preclude compiler optimizations
-  int m_elapsed;
+  int64_t m_elapsed_us;
+};
+
+struct performance_result
+{
+  std::string name;
+  size_t loop_count;
+  bool ok;
+  double time_per_call_us;
+};
+
+struct performance_options
+{
+  std::string filter;    ///<! Run only tests whose name contains this string
+  std::string csv_path;  ///<! Where to write the machine-readable results, if not empty
+  std::vector<performance_result> results;
 };
 
+inline performance_options& get_performance_options()
+{
+  static performance_options options;
+  return options;
+}
+
+/**
+ * One line per test, stable across runs, so results of two builds can be diffed
+ */
+inline bool write_performance_csv(const std::string& path)
+{
+  std::ofstream out(path.c_str());
+  out << "test,loop_count,status,us_per_call\n";
+  for (const performance_result& result : get_performance_options().results)
+  {
+    out << '"' << result.name << "\"," << result.loop_count << ',' << (result.ok ? "OK" : "FAILED") << ',' << result.time_per_call_us << '\n';
+  }
+  return out.good();
+}
+
 template <typename T>
 void run_test(const char* test_name)
 {
+  performance_options& options = get_performance_options();
+  if (!options.filter.empty() && std::string(test_name).find(options.filter) == std::string::npos)
+    return;
+
   test_runner<T> runner;
-  if (runner.run())
+  performance_result result = { test_name, T::loop_count, runner.run(), 0 };
+  if (result.ok)
   {
+    result.time_per_call_us = runner.time_per_call_us();
     std::cout << test_name << " - OK:\n";
     std::cout << "  loop count:    " << T::loop_count << '\n';
     std::cout << "  elapsed:       " << runner.elapsed_time() << " ms\n";
-    std::cout << "  time per call: " << runner.time_per_call() << " ms/call\n" << std::endl;
+    std::cout << "  time per call: " << result.time_per_call_us << " us/call\n" << std::endl;
   }
   else
   {
     std::cout << test_name << " - FAILED" << std::endl;
   }
+
+  options.results.push_back(result);
 }
 
 #define QUOTEME(x) #x
 #define TEST_PERFORMANCE0(test_class)         run_test< test_class >(QUOTEME(test_class))
 #define TEST_PERFORMANCE1(test_class, a0)     run_test< test_class<a0> >(QUOTEME(test_class<a0>))
 #define TEST_PERFORMANCE2(test_class, a0, a1) run_test< test_class<a0, a1> >(QUOTEME(test_class) "<" QUOTEME(a0) ", " QUOTEME(a1) ">")
+#define TEST_PERFORMANCE3(test_class, a0, a1, a2) run_test< test_class<a0, a1, a2> >(QUOTEME(test_class) "<" QUOTEME(a0) ", " QUOTEME(a1) ", " QUOTEME(a2) ">")
+#define TEST_PERFORMANCE4(test_class, a0, a1, a2, a3) run_test< test_class<a0, a1, a2, a3> >(QUOTEME(test_class) "<" QUOTEME(a0) ", " QUOTEME(a1) ", " QUOTEME(a2) ", " QUOTEME(a3) ">")
@@ -0,0 +1,183 @@
+// Copyright (c) 2011-2015 The Cryptonote developers
+// Copyright (c) 2014-2015 XDN developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#pragma once
+
+#include <sstream>
+#include <string>
+
+#include <boost/archive/binary_iarchive.hpp>
+#include <boost/archive/binary_oarchive.hpp>
+
+#include "cryptonote_core/cryptonote_basic.h"
+#include "cryptonote_core/cryptonote_boost_serialization.h"
+#include "cryptonote_core/cryptonote_serialization.h"
+#include "serialization/binary_utils.h"
+#include "serialization/BinaryInputStreamSerializer.h"
+#include "serialization/BinaryOutputStreamSerializer.h"
+#include "serialization/JsonInputStreamSerializer.h"
+#include "serialization/JsonOutputStreamSerializer.h"
+#include "serialization/KVBinaryInputStreamSerializer.h"
+#include "serialization/KVBinaryOutputStreamSerializer.h"
+#include "storages/portable_storage_template_helper.h"
+
+/**
+ * Each format stores an object to a blob and loads it back; failures (including exceptions) return false
+ */
+struct binary_archive_format
+{
+  template <typename T>
+  static bool store(T& value, std::string& blob)
+  {
+    return ::serialization::dump_binary(value, blob);
+  }
+
+  template <typename T>
+  static bool load(const std::string& blob, T& value)
+  {
+    return ::serialization::parse_binary(blob, value);
+  }
+};
+
+struct binary_serializer_format
+{
+  template <typename T>
+  static bool store(T& value, std::string& blob)
+  {
+    std::ostringstream stream;
+    cryptonote::BinaryOutputStreamSerializer serializer(stream);
+    serializer(value, "");
+    blob = stream.str();
+    return stream.good();
+  }
+
+  template <typename T>
+  static bool load(const std::string& blob, T& value)
+  {
+    try
+    {
+      std::istringstream stream(blob);
+      cryptonote::BinaryInputStreamSerializer serializer(stream);
+      serializer(value, "");
+      return true;
+    }
+    catch (std::exception&)
+    {
+      return false;
+    }
+  }
+};
+
+struct kv_binary_format
+{
+  template <typename T>
+  static bool store(T& value, std::string& blob)
+  {
+    std::ostringstream stream;
+    cryptonote::KVBinaryOutputStreamSerializer serializer;
+    serializer(value, "");
+    serializer.write(stream);
+    blob = stream.str();
+    return stream.good();
+  }
+
+  template <typename T>
+  static bool load(const std::string& blob, T& value)
+  {
+    try
+    {
+      std::istringstream stream(blob);
+      cryptonote::KVBinaryInputStreamSerializer serializer(stream);
+      serializer.parse();
+      serializer(value, "");
+      return true;
+    }
+    catch (std::exception&)
+    {
+      return false;
+    }
+  }
+};
+
+/**
+ * JsonInputValueSerializer cannot read binary fields back, so load only measures parsing the text
+ */
+struct json_format
+{
+  template <typename T>
+  static bool store(T& value, std::string& blob)
+  {
+    std::ostringstream stream;
+    cryptonote::JsonOutputStreamSerializer serializer;
+    serializer(value, "");
+    stream << serializer;
+    blob = stream.str();
+    return stream.good();
+  }
+
+  template <typename T>
+  static bool load(const std::string& blob, T& /*value*/)
+  {
+    try
+    {
+      std::istringstream stream(blob);
+      cryptonote::JsonInputStreamSerializer serializer(stream);
+      return true;
+    }
+    catch (std::exception&)
+    {
+      return false;
+    }
+  }
+};
+
+struct boost_binary_format
+{
+  template <typename T>
+  static bool store(T& value, std::string& blob)
+  {
+    std::ostringstream stream;
+    {
+      boost::archive::binary_oarchive archive(stream);
+      archive << value;
+    }
+    blob = stream.str();
+    return stream.good();
+  }
+
+  template <typename T>
+  static bool load(const std::string& blob, T& value)
+  {
+    try
+    {
+      std::istringstream stream(blob);
+      boost::archive::binary_iarchive archive(stream);
+      archive >> value;
+      return true;
+    }
+    catch (std::exception&)
+    {
+      return false;
+    }
+  }
+};
+
+/**
+ * epee portable storage, the format of the p2p and binary RPC payloads; needs a KV_SERIALIZE map
+ */
+struct epee_portable_storage_format
+{
+  template <typename T>
+  static bool store(T& value, std::string& blob)
+  {
+    return epee::serialization::store_t_to_binary(value, blob);
+  }
+
+  template <typename T>
+  static bool load(const std::string& blob, T& value)
+  {
+    return epee::serialization::load_t_from_binary(value, blob);
+  }
+};
@@ -0,0 +1,99 @@
+// Copyright (c) 2011-2015 The Cryptonote developers
+// Copyright (c) 2014-2015 XDN developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#pragma once
+
+#include <string>
+
+#include "crypto/crypto.h"
+#include "cryptonote_config.h"
+#include "cryptonote_core/account.h"
+#include "cryptonote_core/cryptonote_basic.h"
+#include "cryptonote_core/Currency.h"
+
+#include "serialization_formats.h"
+
+template<size_t a_tx_count>
+class block_test_base
+{
+public:
+  static const size_t tx_count = a_tx_count;
+
+  bool init()
+  {
+    using namespace cryptonote;
+
+    Currency currency = CurrencyBuilder().currency();
+    m_miner.generate();
+
+    m_block.majorVersion = BLOCK_MAJOR_VERSION_1;
+    m_block.minorVersion = BLOCK_MINOR_VERSION_0;
+    m_block.timestamp = 1400000000;
+    m_block.prevId = crypto::rand<crypto::hash>();
+    m_block.nonce = crypto::rand<uint32_t>();
+    if (!currency.constructMinerTx(0, 0, 0, 0, 0, m_miner.get_keys().m_account_address, m_block.minerTx))
+      return false;
+
+    for (size_t i = 0; i < tx_count; ++i)
+    {
+      m_block.txHashes.push_back(crypto::rand<crypto::hash>());
+    }
+
+    return true;
+  }
+
+protected:
+  cryptonote::account_base m_miner;
+  cryptonote::Block m_block;
+};
+
+template<typename Format, size_t a_tx_count>
+class test_serialize_block : private block_test_base<a_tx_count>
+{
+public:
+  static const size_t loop_count = 1000;
+
+  typedef block_test_base<a_tx_count> base_class;
+
+  bool init()
+  {
+    return base_class::init();
+  }
+
+  bool test()
+  {
+    m_blob.clear();
+    return Format::store(this->m_block, m_blob) && !m_blob.empty();
+  }
+
+private:
+  std::string m_blob;
+};
+
+template<typename Format, size_t a_tx_count>
+class test_parse_block : private block_test_base<a_tx_count>
+{
+public:
+  static const size_t loop_count = 1000;
+
+  typedef block_test_base<a_tx_count> base_class;
+
+  bool init()
+  {
+    if (!base_class::init())
+      return false;
+
+    return Format::store(this->m_block, m_blob);
+  }
+
+  bool test()
+  {
+    cryptonote::Block block;
+    return Format::load(m_blob, block);
+  }
+
+private:
+  std::string m_blob;
+};
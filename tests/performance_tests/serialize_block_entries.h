@@ -0,0 +1,140 @@
+// Copyright (c) 2011-2015 The Cryptonote developers
+// Copyright (c) 2014-2015 XDN developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#pragma once
+
+#include <list>
+#include <string>
+
+#include "cryptonote_core/cryptonote_format_utils.h"
+#include "cryptonote_protocol/cryptonote_protocol_defs.h"
+#include "serialization/ISerializer.h"
+
+#include "serialization_formats.h"
+#include "serialize_block.h"
+#include "serialize_transaction.h"
+
+namespace cryptonote
+{
+  /**
+   * Body of NOTIFY_RESPONSE_GET_OBJECTS / COMMAND_RPC_GET_BLOCKS_FAST responses reduced to the block list
+   */
+  struct block_entries_payload
+  {
+    std::list<block_complete_entry> blocks;
+
+    BEGIN_KV_SERIALIZE_MAP()
+      KV_SERIALIZE(blocks)
+    END_KV_SERIALIZE_MAP()
+  };
+
+  inline void serialize(block_complete_entry& entry, const std::string& name, ISerializer& serializer)
+  {
+    serializer.beginObject(name);
+    serializer.binary(entry.block, "block");
+
+    std::size_t size = entry.txs.size();
+    serializer.beginArray(size, "txs");
+    entry.txs.resize(size);
+    for (blobdata& tx : entry.txs)
+    {
+      serializer.binary(tx, "");
+    }
+    serializer.endArray();
+
+    serializer.endObject();
+  }
+
+  inline void serialize(block_entries_payload& payload, const std::string& name, ISerializer& serializer)
+  {
+    serializer.beginObject(name);
+
+    std::size_t size = payload.blocks.size();
+    serializer.beginArray(size, "blocks");
+    payload.blocks.resize(size);
+    for (block_complete_entry& entry : payload.blocks)
+    {
+      serializer(entry, "");
+    }
+    serializer.endArray();
+
+    serializer.endObject();
+  }
+}
+
+template<size_t a_block_count, size_t a_txs_per_block>
+class block_entries_test_base : protected block_test_base<a_txs_per_block>, protected tx_serialization_test_base<1, 2, 1>
+{
+public:
+  static const size_t block_count = a_block_count;
+  static const size_t txs_per_block = a_txs_per_block;
+
+  bool init()
+  {
+    using namespace cryptonote;
+
+    if (!block_test_base<a_txs_per_block>::init() || !tx_serialization_test_base<1, 2, 1>::init())
+      return false;
+
+    block_complete_entry entry;
+    entry.block = block_to_blob(this->m_block);
+    entry.txs.assign(txs_per_block, tx_to_blob(this->m_tx));
+    m_payload.blocks.assign(block_count, entry);
+
+    return true;
+  }
+
+protected:
+  cryptonote::block_entries_payload m_payload;
+};
+
+template<typename Format, size_t a_block_count, size_t a_txs_per_block>
+class test_serialize_block_entries : private block_entries_test_base<a_block_count, a_txs_per_block>
+{
+public:
+  static const size_t loop_count = 100;
+
+  typedef block_entries_test_base<a_block_count, a_txs_per_block> base_class;
+
+  bool init()
+  {
+    return base_class::init();
+  }
+
+  bool test()
+  {
+    m_blob.clear();
+    return Format::store(this->m_payload, m_blob) && !m_blob.empty();
+  }
+
+private:
+  std::string m_blob;
+};
+
+template<typename Format, size_t a_block_count, size_t a_txs_per_block>
+class test_parse_block_entries : private block_entries_test_base<a_block_count, a_txs_per_block>
+{
+public:
+  static const size_t loop_count = 100;
+
+  typedef block_entries_test_base<a_block_count, a_txs_per_block> base_class;
+
+  bool init()
+  {
+    if (!base_class::init())
+      return false;
+
+    return Format::store(this->m_payload, m_blob);
+  }
+
+  bool test()
+  {
+    cryptonote::block_entries_payload payload;
+    return Format::load(m_blob, payload);
+  }
+
+private:
+  std::string m_blob;
+};
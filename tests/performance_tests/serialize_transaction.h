@@ -0,0 +1,102 @@
+// Copyright (c) 2011-2015 The Cryptonote developers
+// Copyright (c) 2014-2015 XDN developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "cryptonote_core/account.h"
+#include "cryptonote_core/cryptonote_basic.h"
+#include "cryptonote_core/cryptonote_format_utils.h"
+
+#include "multi_tx_test_base.h"
+#include "serialization_formats.h"
+
+template<size_t a_in_count, size_t a_out_count, size_t a_ring_size>
+class tx_serialization_test_base : protected multi_tx_test_base<a_ring_size>
+{
+  static_assert(0 < a_in_count, "in_count must be greater than 0");
+  static_assert(0 < a_out_count, "out_count must be greater than 0");
+
+public:
+  static const size_t in_count  = a_in_count;
+  static const size_t out_count = a_out_count;
+
+  typedef multi_tx_test_base<a_ring_size> base_class;
+
+  bool init()
+  {
+    using namespace cryptonote;
+
+    if (!base_class::init())
+      return false;
+
+    //every input spends the same ring, it only has to have the right shape
+    std::vector<tx_source_entry> sources(in_count, this->m_sources.front());
+
+    m_alice.generate();
+    std::vector<tx_destination_entry> destinations;
+    for (size_t i = 0; i < out_count; ++i)
+    {
+      destinations.push_back(tx_destination_entry(this->m_source_amount / out_count, m_alice.get_keys().m_account_address));
+    }
+
+    return construct_tx(this->m_miners[this->real_source_idx].get_keys(), sources, destinations, std::vector<uint8_t>(), m_tx, 0);
+  }
+
+protected:
+  cryptonote::account_base m_alice;
+  cryptonote::Transaction m_tx;
+};
+
+template<typename Format, size_t a_in_count, size_t a_out_count, size_t a_ring_size>
+class test_serialize_transaction : private tx_serialization_test_base<a_in_count, a_out_count, a_ring_size>
+{
+public:
+  static const size_t loop_count = 1000;
+
+  typedef tx_serialization_test_base<a_in_count, a_out_count, a_ring_size> base_class;
+
+  bool init()
+  {
+    return base_class::init();
+  }
+
+  bool test()
+  {
+    m_blob.clear();
+    return Format::store(this->m_tx, m_blob) && !m_blob.empty();
+  }
+
+private:
+  std::string m_blob;
+};
+
+template<typename Format, size_t a_in_count, size_t a_out_count, size_t a_ring_size>
+class test_parse_transaction : private tx_serialization_test_base<a_in_count, a_out_count, a_ring_size>
+{
+public:
+  static const size_t loop_count = 1000;
+
+  typedef tx_serialization_test_base<a_in_count, a_out_count, a_ring_size> base_class;
+
+  bool init()
+  {
+    if (!base_class::init())
+      return false;
+
+    return Format::store(this->m_tx, m_blob);
+  }
+
+  bool test()
+  {
+    cryptonote::Transaction tx;
+    return Format::load(m_blob, tx);
+  }
+
+private:
+  std::string m_blob;
+};
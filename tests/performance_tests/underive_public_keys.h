@@ -0,0 +1,57 @@
+// Copyright (c) 2011-2015 The Cryptonote developers
+// Copyright (c) 2014-2015 XDN developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include "crypto/crypto.h"
+#include "cryptonote_core/cryptonote_basic.h"
+
+#include "single_tx_test_base.h"
+
+template<size_t batch_size>
+class test_underive_public_keys : public single_tx_test_base
+{
+public:
+  static const size_t loop_count = 100;
+
+  bool init()
+  {
+    if (!single_tx_test_base::init())
+      return false;
+
+    crypto::key_derivation derivation;
+    crypto::generate_key_derivation(m_tx_pub_key, m_bob.get_keys().m_view_secret_key, derivation);
+
+    m_derivations.assign(batch_size, derivation);
+    m_output_indexes.resize(batch_size);
+    m_derived_keys.resize(batch_size);
+    for (size_t i = 0; i < batch_size; ++i)
+    {
+      m_output_indexes[i] = i;
+      crypto::derive_public_key(derivation, i, m_bob.get_keys().m_account_address.m_spendPublicKey, m_derived_keys[i]);
+    }
+
+    m_bases.resize(batch_size);
+    m_valid.reset(new bool[batch_size]);
+    return true;
+  }
+
+  bool test()
+  {
+    crypto::underive_public_keys(m_derivations.data(), m_output_indexes.data(), m_derived_keys.data(), batch_size,
+      m_bases.data(), m_valid.get());
+    return m_valid[0] && m_bases[0] == m_bob.get_keys().m_account_address.m_spendPublicKey;
+  }
+
+private:
+  std::vector<crypto::key_derivation> m_derivations;
+  std::vector<size_t> m_output_indexes;
+  std::vector<crypto::public_key> m_derived_keys;
+  std::vector<crypto::public_key> m_bases;
+  std::unique_ptr<bool[]> m_valid;
+};
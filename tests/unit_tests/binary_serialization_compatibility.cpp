@@ -337,6 +337,27 @@ TEST(BinarySerializationCompatibility, Block) {
   checkCompatibility(block);
 }
 
+TEST(BinarySerializationCompatibility, hashVectorIsWrittenBackToBack) {
+  std::vector<crypto::hash> hashes(5);
+  for (size_t i = 0; i < hashes.size(); ++i) {
+    fillHash(hashes[i], static_cast<char>(i));
+  }
+
+  checkCompatibility(hashes);
+
+  std::stringstream archive;
+  cryptonote::BinaryOutputStreamSerializer output(archive);
+  output(hashes, "");
+  ASSERT_EQ(1 + hashes.size() * sizeof(crypto::hash), archive.str().size());
+
+  std::string truncated = archive.str();
+  truncated.resize(truncated.size() - 1);
+  std::stringstream truncatedStream(truncated);
+  std::vector<crypto::hash> restored;
+  cryptonote::BinaryInputStreamSerializer input(truncatedStream);
+  ASSERT_ANY_THROW(input(restored, ""));
+}
+
 TEST(BinarySerializationCompatibility, account_public_address) {
   cryptonote::AccountPublicAddress addr;
 
@@ -128,6 +128,30 @@ TEST(Serialization, BinaryArchiveVarInts) {
   ASSERT_EQ(x, x1);
 }
 
+TEST(Serialization, MemoryBinaryArchive) {
+  uint64_t x = 0xff00000000, x1;
+  vector<crypto::hash> hashes(3), hashes1;
+  memset(hashes.data(), 0x5a, hashes.size() * sizeof(crypto::hash));
+
+  ostringstream oss;
+  binary_archive<true> oar(oss);
+  oar.serialize_varint(x);
+  ASSERT_TRUE(::do_serialize(oar, hashes));
+  string blob = oss.str();
+
+  memory_binary_archive<false> iar(blob);
+  iar.serialize_varint(x1);
+  ASSERT_TRUE(::do_serialize(iar, hashes1));
+  ASSERT_TRUE(serialization::check_stream_state(iar));
+  ASSERT_EQ(x, x1);
+  ASSERT_EQ(hashes, hashes1);
+
+  memory_binary_archive<false> truncated(blob.data(), blob.size() - 1);
+  truncated.serialize_varint(x1);
+  ASSERT_FALSE(::do_serialize(truncated, hashes1));
+  ASSERT_FALSE(truncated.stream().good());
+}
+
 TEST(Serialization, Test1) {
   ostringstream str;
   binary_archive<true> ar(str);
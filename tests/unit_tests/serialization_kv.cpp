@@ -226,3 +226,62 @@ TEST(KVSerialize, NewWriterOldReader) {
 
 
 }
+
+TEST(KVSerialize, ReaderLooksUpKeysOutOfOrder) {
+  TestStruct s1;
+  s1.u8 = 7;
+  s1.u32 = 0xdeadbeef;
+  s1.u64 = 0xffULL << 50;
+  s1.vec1.resize(3);
+  s1.vec1[1].name = "second";
+  s1.root.name = "somename";
+  s1.root.blob.fill(0x5a);
+
+  std::string buf;
+  epee::serialization::store_t_to_binary(s1, buf);
+
+  std::stringstream s(buf);
+  KVBinaryInputStreamSerializer kvInput(s);
+  kvInput.parse();
+
+  uint8_t u8 = 0;
+  uint32_t u32 = 0;
+  uint64_t u64 = 0;
+  std::vector<TestElement> vec1;
+  TestElement root;
+  std::string missing = "untouched";
+
+  kvInput.beginObject("");
+  kvInput(u64, "u64");
+  kvInput(vec1, "vec1");
+  kvInput(u8, "u8");
+  EXPECT_FALSE(kvInput.hasObject("nosuchkey"));
+  kvInput.binary(missing, "nosuchkey");
+  kvInput(root, "root");
+  kvInput(u32, "u32");
+  kvInput.endObject();
+
+  EXPECT_EQ(s1.u8, u8);
+  EXPECT_EQ(s1.u32, u32);
+  EXPECT_EQ(s1.u64, u64);
+  EXPECT_EQ(s1.vec1, vec1);
+  EXPECT_EQ(s1.root, root);
+  EXPECT_TRUE(missing.empty());
+}
+
+TEST(KVSerialize, ReaderRejectsTruncatedData) {
+  TestStruct s1;
+  s1.vec1.resize(5);
+  s1.root.u32array.resize(64);
+
+  std::string buf;
+  epee::serialization::store_t_to_binary(s1, buf);
+  buf.resize(buf.size() - 10);
+
+  std::stringstream s(buf);
+  KVBinaryInputStreamSerializer kvInput(s);
+  kvInput.parse();
+
+  TestStruct outStruct;
+  ASSERT_THROW(kvInput(outStruct, ""), std::runtime_error);
+}
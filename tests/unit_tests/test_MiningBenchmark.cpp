@@ -0,0 +1,67 @@
+// Copyright (c) 2011-2015 The Cryptonote developers
+// Copyright (c) 2014-2015 XDN developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "gtest/gtest.h"
+
+#include <sstream>
+
+#include "cryptonote_core/MiningBenchmark.h"
+
+using namespace cryptonote;
+
+namespace {
+
+MiningBenchmarkConfig makeShortConfig() {
+  MiningBenchmarkConfig config;
+  config.enabled = true;
+  config.threadCounts = {1, 2};
+  config.ways = {1, 2};
+  config.hugePages = {false};
+  config.pinnings = {MiningBenchmarkPinning::NONE, MiningBenchmarkPinning::COMPACT};
+  config.duration = std::chrono::milliseconds(100);
+  config.verifications = 5;
+  return config;
+}
+
+}
+
+TEST(MiningBenchmark, SweepsEveryConfiguration) {
+  Currency currency = CurrencyBuilder().currency();
+  MiningBenchmark benchmark(currency, makeShortConfig());
+  ASSERT_TRUE(benchmark.run());
+
+  const std::vector<MiningBenchmarkResult>& results = benchmark.getMiningResults();
+  ASSERT_EQ(8, results.size());
+  for (const MiningBenchmarkResult& result : results) {
+    ASSERT_GT(result.hashesPerSecond, 0);
+    ASSERT_DOUBLE_EQ(result.hashesPerSecond, result.threadHashesPerSecond * result.threads);
+    ASSERT_GE(result.threadStdDeviation, 0);
+    ASSERT_FALSE(result.memoryBacking.empty());
+  }
+
+  ASSERT_EQ(2, results[2].ways);
+  ASSERT_EQ(MiningBenchmarkPinning::COMPACT, results[1].pinning);
+  ASSERT_EQ(2, results[4].threads);
+
+  const std::vector<VerificationBenchmarkResult>& verifications = benchmark.getVerificationResults();
+  ASSERT_EQ(1, verifications.size());
+  ASSERT_EQ(5, verifications[0].verifications);
+  ASSERT_GT(verifications[0].medianMs, 0);
+  ASSERT_LE(verifications[0].medianMs, verifications[0].p90Ms);
+  ASSERT_LE(verifications[0].p90Ms, verifications[0].p99Ms);
+  ASSERT_LE(verifications[0].p99Ms, verifications[0].maxMs);
+
+  std::ostringstream report;
+  benchmark.print(report);
+  ASSERT_NE(std::string::npos, report.str().find("compact"));
+}
+
+TEST(MiningBenchmark, RejectsUnsupportedWays) {
+  Currency currency = CurrencyBuilder().currency();
+  MiningBenchmarkConfig config = makeShortConfig();
+  config.ways = {3};
+  MiningBenchmark benchmark(currency, config);
+  ASSERT_FALSE(benchmark.run());
+}
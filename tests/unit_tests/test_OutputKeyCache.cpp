@@ -0,0 +1,105 @@
+// Copyright (c) 2011-2015 The Cryptonote developers
+// Copyright (c) 2014-2015 XDN developers
+// Distributed under the MIT/X11 software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include "gtest/gtest.h"
+
+#include <cstring>
+#include <vector>
+
+#include <cryptonote_core/OutputKeyCache.h>
+
+using namespace cryptonote;
+
+namespace {
+
+crypto::public_key generatePublicKey() {
+  crypto::public_key publicKey;
+  crypto::secret_key secretKey;
+  crypto::generate_keys(publicKey, secretKey);
+  return publicKey;
+}
+
+crypto::public_key generateInvalidKey() {
+  crypto::public_key key;
+  do {
+    key = crypto::rand<crypto::public_key>();
+  } while (crypto::check_key(key));
+  return key;
+}
+
+}
+
+TEST(OutputKeyCache, SecondLookupIsHit) {
+  OutputKeyCache cache(64);
+  crypto::public_key key = generatePublicKey();
+  crypto::prepared_public_key first;
+  crypto::prepared_public_key second;
+
+  ASSERT_TRUE(cache.get(key, first));
+  ASSERT_TRUE(cache.get(key, second));
+  ASSERT_EQ(1, cache.getHits());
+  ASSERT_EQ(1, cache.getMisses());
+  ASSERT_EQ(1, cache.size());
+  ASSERT_EQ(0, memcmp(&first, &second, sizeof(first)));
+}
+
+TEST(OutputKeyCache, MatchesPreparedKey) {
+  OutputKeyCache cache(64);
+  crypto::public_key key = generatePublicKey();
+  crypto::prepared_public_key expected;
+  crypto::prepared_public_key cached;
+
+  ASSERT_TRUE(crypto::prepare_public_key(key, expected));
+  ASSERT_TRUE(cache.get(key, cached));
+  ASSERT_EQ(0, memcmp(&expected, &cached, sizeof(expected)));
+}
+
+TEST(OutputKeyCache, InvalidKeyIsRejectedAndNotCached) {
+  OutputKeyCache cache(64);
+  crypto::prepared_public_key prepared;
+
+  ASSERT_FALSE(cache.get(generateInvalidKey(), prepared));
+  ASSERT_EQ(0, cache.size());
+}
+
+TEST(OutputKeyCache, SizeIsBounded) {
+  OutputKeyCache cache(16);
+  crypto::prepared_public_key prepared;
+  for (size_t i = 0; i < 200; ++i) {
+    ASSERT_TRUE(cache.get(generatePublicKey(), prepared));
+  }
+
+  ASSERT_LE(cache.size(), cache.capacity());
+  ASSERT_EQ(200, cache.getMisses());
+}
+
+TEST(OutputKeyCache, PreparedKeysCheckRingSignature) {
+  const size_t ringSize = 4;
+  const size_t realIndex = 2;
+  std::vector<crypto::public_key> publicKeys(ringSize);
+  std::vector<crypto::secret_key> secretKeys(ringSize);
+  std::vector<const crypto::public_key*> publicKeyPtrs;
+  for (size_t i = 0; i < ringSize; ++i) {
+    crypto::generate_keys(publicKeys[i], secretKeys[i]);
+    publicKeyPtrs.push_back(&publicKeys[i]);
+  }
+
+  crypto::key_image keyImage;
+  crypto::generate_key_image(publicKeys[realIndex], secretKeys[realIndex], keyImage);
+  crypto::hash prefixHash = crypto::rand<crypto::hash>();
+  std::vector<crypto::signature> signatures(ringSize);
+  crypto::generate_ring_signature(prefixHash, keyImage, publicKeyPtrs, secretKeys[realIndex], realIndex, signatures.data());
+
+  OutputKeyCache cache(64);
+  std::vector<crypto::prepared_public_key> preparedKeys(ringSize);
+  std::vector<const crypto::prepared_public_key*> preparedKeyPtrs;
+  for (size_t i = 0; i < ringSize; ++i) {
+    ASSERT_TRUE(cache.get(publicKeys[i], preparedKeys[i]));
+    preparedKeyPtrs.push_back(&preparedKeys[i]);
+  }
+
+  ASSERT_TRUE(crypto::check_ring_signature(prefixHash, keyImage, preparedKeyPtrs, signatures.data()));
+  ASSERT_FALSE(crypto::check_ring_signature(crypto::rand<crypto::hash>(), keyImage, preparedKeyPtrs, signatures.data()));
+}
@@ -12,8 +12,10 @@
 
 #include "common/util.h"
 #include "cryptonote_core/account.h"
+#include "cryptonote_core/BlockHashingBlob.h"
 #include "cryptonote_core/cryptonote_format_utils.h"
 #include "cryptonote_core/Currency.h"
+#include "cryptonote_core/ProofOfWorkVerifier.h"
 
 
 TEST(parse_tx_extra, handles_empty_extra)
@@ -182,3 +184,149 @@ TEST(validate_parse_amount_case, validate_parse_amount)
   r = currency.parseAmount("1 00.00 00", res);
   ASSERT_FALSE(r);
 }
+
+namespace
+{
+  cryptonote::Block makeTestBlock(size_t txCount)
+  {
+    cryptonote::Currency currency = cryptonote::CurrencyBuilder().currency();
+    cryptonote::account_base miner;
+    miner.generate();
+
+    cryptonote::Block block;
+    block.majorVersion = cryptonote::BLOCK_MAJOR_VERSION_1;
+    block.minorVersion = cryptonote::BLOCK_MINOR_VERSION_0;
+    block.timestamp = 1400000000;
+    block.prevId = crypto::rand<crypto::hash>();
+    block.nonce = 12345;
+    currency.constructMinerTx(0, 0, 0, 0, 0, miner.get_keys().m_account_address, block.minerTx);
+    for (size_t i = 0; i < txCount; ++i)
+    {
+      block.txHashes.push_back(crypto::rand<crypto::hash>());
+    }
+
+    return block;
+  }
+}
+
+TEST(BlockHashingBlob, patchedNonceMatchesReserializedBlob)
+{
+  cryptonote::Block block = makeTestBlock(3);
+  cryptonote::BlockHashingBlob blob;
+  ASSERT_TRUE(blob.init(block));
+  ASSERT_EQ(block.nonce, blob.getNonce());
+
+  const uint32_t nonces[] = {0, 1, 0x12345678, 0xFFFFFFFF};
+  for (uint32_t nonce : nonces)
+  {
+    block.nonce = nonce;
+    cryptonote::blobdata expected;
+    ASSERT_TRUE(cryptonote::get_block_hashing_blob(block, expected));
+
+    blob.setNonce(nonce);
+    ASSERT_EQ(nonce, blob.getNonce());
+    ASSERT_EQ(expected, blob.getBlob());
+  }
+
+  crypto::cn_context context;
+  crypto::hash expectedHash;
+  crypto::hash hash;
+  ASSERT_TRUE(cryptonote::get_block_longhash(context, block, expectedHash));
+  blob.getLongHash(context, hash);
+  ASSERT_EQ(expectedHash, hash);
+}
+
+TEST(BlockHashingBlob, locatesNonceInForeignBlob)
+{
+  cryptonote::Block block = makeTestBlock(0);
+  cryptonote::blobdata hashingBlob;
+  ASSERT_TRUE(cryptonote::get_block_hashing_blob(block, hashingBlob));
+
+  cryptonote::BlockHashingBlob blob;
+  ASSERT_TRUE(blob.init(hashingBlob));
+  ASSERT_EQ(block.nonce, blob.getNonce());
+
+  block.nonce = 777;
+  blob.setNonce(777);
+  ASSERT_TRUE(cryptonote::get_block_hashing_blob(block, hashingBlob));
+  ASSERT_EQ(hashingBlob, blob.getBlob());
+
+  ASSERT_FALSE(blob.init(hashingBlob.substr(0, 10)));
+}
+
+TEST(ProofOfWorkVerifier, matchesSerialLongHashes)
+{
+  std::vector<cryptonote::Block> blocks;
+  for (uint32_t i = 0; i < 5; ++i)
+  {
+    blocks.push_back(makeTestBlock(i));
+    blocks.back().nonce = i;
+  }
+
+  crypto::cn_context context;
+  std::vector<crypto::hash> expected;
+  for (const cryptonote::Block& block : blocks)
+  {
+    crypto::hash hash;
+    ASSERT_TRUE(cryptonote::get_block_longhash(context, block, hash));
+    expected.push_back(hash);
+  }
+
+  cryptonote::ProofOfWorkVerifier verifier(2);
+  std::vector<crypto::hash> longHashes;
+  ASSERT_TRUE(verifier.getLongHashes(blocks, longHashes));
+  ASSERT_EQ(expected, longHashes);
+
+  //the workers are reused by the next batch
+  blocks.resize(1);
+  ASSERT_TRUE(verifier.getLongHashes(blocks, longHashes));
+  ASSERT_EQ(1, longHashes.size());
+  ASSERT_EQ(expected[0], longHashes[0]);
+
+  ASSERT_TRUE(verifier.getLongHashes(std::vector<cryptonote::Block>(), longHashes));
+  ASSERT_TRUE(longHashes.empty());
+}
+
+TEST(get_block_hashes, matchesSingleBlockHashes)
+{
+  std::vector<cryptonote::Block> blocks;
+  for (uint32_t i = 0; i < 11; ++i)
+  {
+    blocks.push_back(makeTestBlock(i * 3));
+    blocks.back().nonce = i;
+  }
+
+  std::vector<crypto::hash> hashes;
+  ASSERT_TRUE(cryptonote::get_block_hashes(blocks, hashes));
+  ASSERT_EQ(blocks.size(), hashes.size());
+  for (size_t i = 0; i < blocks.size(); ++i)
+  {
+    ASSERT_EQ(cryptonote::get_block_hash(blocks[i]), hashes[i]);
+  }
+
+  ASSERT_TRUE(cryptonote::get_block_hashes(std::vector<cryptonote::Block>(), hashes));
+  ASSERT_TRUE(hashes.empty());
+}
+
+TEST(tree_branch, rebuildsTreeHashOfFirstLeaf)
+{
+  for (size_t count = 1; count < 70; ++count)
+  {
+    std::vector<crypto::hash> hashes;
+    for (size_t i = 0; i < count; ++i)
+    {
+      hashes.push_back(crypto::rand<crypto::hash>());
+    }
+
+    crypto::hash root;
+    crypto::tree_hash(hashes.data(), hashes.size(), root);
+
+    size_t depth = crypto::tree_depth(count);
+    std::vector<crypto::hash> branch(depth + 1);
+    crypto::tree_branch(hashes.data(), hashes.size(), branch.data());
+
+    crypto::hash rebuiltRoot;
+    crypto::tree_hash_from_branch(branch.data(), depth, hashes[0], nullptr, rebuiltRoot);
+    ASSERT_EQ(root, rebuiltRoot) << "count " << count;
+  }
+}